@@ -0,0 +1,327 @@
+#include <queue>
+#include <algorithm>
+#include <stdexcept>
+#include "AhoCorasick.h"
+
+/**
+ * fixed part of an image, followed by the tables in member order
+ */
+struct ImageHeader
+{
+    uint32_t classes;
+    uint32_t reserved;
+    uint64_t states;
+    uint64_t phrases;
+};
+
+/**
+ *
+ * @param bytes
+ * @return bytes rounded up to a whole section
+ */
+static size_t alignSection(size_t bytes)
+{ return (bytes + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN; }
+
+/**
+ *
+ * @param states
+ * @param classes
+ * @return if states fit in the uint32_t state ids, and a states x classes transition table of them
+ * can be sized and indexed in size_t
+ */
+static bool tableFits(size_t states, size_t classes)
+{ return states <= UINT32_MAX && states <= SIZE_MAX / sizeof(uint32_t) / classes; }
+
+/**
+ * writes a table, padded to a whole section
+ * @param out
+ * @param data
+ * @param bytes
+ * @return bytes written
+ */
+static size_t writeSection(std::ostream& out, const void* data, size_t bytes)
+{
+    static const char pad[SECTION_ALIGN] = {};
+    out.write(static_cast<const char*>(data), bytes);
+    out.write(pad, alignSection(bytes) - bytes);
+    return alignSection(bytes);
+}
+
+/**
+ * ctor, builds the trie over a compressed alphabet and then links it
+ * @param phrases
+ * @param points
+ */
+AhoCorasick::AhoCorasick(const std::vector<std::string>& phrases, const std::vector<int>& points) :
+    _ownClassOf(ALPHABET, 0), _ownPoints(points.begin(), points.end()), _classes(1)
+{
+    if (phrases.size() != points.size())
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //only bytes used by some phrase get their own column
+    for (const std::string& phrase : phrases)
+    {
+        for (unsigned char c : phrase)
+        {
+            if (_ownClassOf[c] == 0)
+            {
+                _ownClassOf[c] = _classes++;
+            }
+        }
+    }
+
+    _ownNext.assign(_classes, ROOT);
+    _ownOut.push_back(NO_PATTERN);
+    for (size_t i = 0; i < phrases.size(); ++i)
+    {
+        uint32_t state = ROOT;
+        for (unsigned char c : phrases[i])
+        {
+            uint32_t& child = _ownNext[(size_t) state * _classes + _ownClassOf[c]];
+            if (child == ROOT)
+            {
+                if (!tableFits(_ownOut.size() + 1, _classes))
+                {
+                    throw std::invalid_argument("exiting ctor due to illegal params\n");
+                }
+                child = (uint32_t) _ownOut.size();
+                _ownOut.push_back(NO_PATTERN);
+                _ownNext.resize(_ownNext.size() + _classes, ROOT);
+            }
+            //_ownNext may have moved, so index again
+            state = _ownNext[(size_t) state * _classes + _ownClassOf[c]];
+        }
+        _ownOut[state] = (int32_t) i;
+    }
+    _link();
+    _foldCase();
+    _own();
+}
+
+/**
+ * ctor, points the tables into the image
+ * @param image
+ * @param len
+ */
+AhoCorasick::AhoCorasick(const char* image, size_t len) : _classes(0), _states(0), _phrases(0)
+{
+    if (len < sizeof(ImageHeader))
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    const ImageHeader* header = reinterpret_cast<const ImageHeader*>(image);
+    _classes = header->classes;
+    _states = header->states;
+    _phrases = header->phrases;
+
+    //counts are checked against len before any size is computed from them, so nothing overflows
+    if (_classes == 0 || _classes > ALPHABET || _states == 0 || !tableFits(_states, _classes) ||
+        _states > len / sizeof(uint32_t) / _classes || _phrases > len / sizeof(int32_t))
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    size_t need = sizeof(ImageHeader) + alignSection(ALPHABET) +
+                  alignSection(_states * _classes * sizeof(uint32_t)) + 2 * alignSection(_states * sizeof(uint32_t)) +
+                  alignSection(_phrases * sizeof(int32_t));
+    if (need > len)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    const char* p = image + sizeof(ImageHeader);
+    _classOf = reinterpret_cast<const unsigned char*>(p);
+    p += alignSection(ALPHABET);
+    _next = reinterpret_cast<const uint32_t*>(p);
+    p += alignSection(_states * _classes * sizeof(uint32_t));
+    _out = reinterpret_cast<const int32_t*>(p);
+    p += alignSection(_states * sizeof(int32_t));
+    _outLink = reinterpret_cast<const uint32_t*>(p);
+    p += alignSection(_states * sizeof(uint32_t));
+    _points = reinterpret_cast<const int32_t*>(p);
+    _validate();
+
+    //images may predate case folding, the class table is small enough to fold a copy of
+    _ownClassOf.assign(_classOf, _classOf + ALPHABET);
+    _foldCase();
+    _classOf = _ownClassOf.data();
+}
+
+/**
+ * one pass over the viewed tables. a scan indexes with every entry it can reach, so an entry out
+ * of range, or an output link chain that never gets back to ROOT, would read past the image or
+ * never end
+ */
+void AhoCorasick::_validate() const
+{
+    if (!tableFits(_states, _classes))
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    for (size_t c = 0; c < ALPHABET; ++c)
+    {
+        if (_classOf[c] >= _classes)
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+    }
+    for (size_t i = 0; i < _states * _classes; ++i)
+    {
+        if (_next[i] >= _states)
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+    }
+    for (size_t s = 0; s < _states; ++s)
+    {
+        //an output link leads to a state with a phrase, the scan reads its phrase without checking
+        if ((_out[s] != NO_PATTERN && (_out[s] < 0 || (size_t) _out[s] >= _phrases)) || _outLink[s] >= _states ||
+            (_outLink[s] != ROOT && _out[_outLink[s]] == NO_PATTERN))
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+    }
+
+    //every chain ends at ROOT. a state is marked once it is on the current chain, and again once
+    //its chain is known to end, so every state is walked once
+    std::vector<unsigned char> mark(_states, 0);
+    std::vector<uint32_t> chain;
+    mark[ROOT] = 2;
+    for (size_t s = 0; s < _states; ++s)
+    {
+        uint32_t t = (uint32_t) s;
+        while (mark[t] == 0)
+        {
+            mark[t] = 1;
+            chain.push_back(t);
+            t = _outLink[t];
+        }
+        if (mark[t] == 1)
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+        for (uint32_t u : chain)
+        {
+            mark[u] = 2;
+        }
+        chain.clear();
+    }
+}
+
+void AhoCorasick::_foldCase()
+{
+    for (int c = 'A'; c <= 'Z'; ++c)
+    {
+        if (_ownClassOf[c] == 0)
+        {
+            _ownClassOf[c] = _ownClassOf[c | 0x20];
+        }
+    }
+}
+
+void AhoCorasick::_own()
+{
+    _states = _ownOut.size();
+    _phrases = _ownPoints.size();
+    _classOf = _ownClassOf.data();
+    _next = _ownNext.data();
+    _out = _ownOut.data();
+    _outLink = _ownOutLink.data();
+    _points = _ownPoints.data();
+}
+
+/**
+ * bfs over the trie. a missing edge of a state is replaced by the edge of its failure state, which
+ * is already final since it is shallower
+ */
+void AhoCorasick::_link()
+{
+    std::vector<uint32_t> fail(_ownOut.size(), ROOT);
+    _ownOutLink.assign(_ownOut.size(), ROOT);
+    std::queue<uint32_t> queue;
+    for (uint32_t c = 0; c < _classes; ++c)
+    {
+        if (_ownNext[c] != ROOT)
+        {
+            queue.push(_ownNext[c]);
+        }
+    }
+
+    while (!queue.empty())
+    {
+        uint32_t state = queue.front();
+        queue.pop();
+        uint32_t f = fail[state];
+        _ownOutLink[state] = (_ownOut[f] != NO_PATTERN) ? f : _ownOutLink[f];
+        for (uint32_t c = 0; c < _classes; ++c)
+        {
+            uint32_t& child = _ownNext[(size_t) state * _classes + c];
+            if (child != ROOT)
+            {
+                fail[child] = _ownNext[(size_t) f * _classes + c];
+                queue.push(child);
+            }
+            else
+            {
+                child = _ownNext[(size_t) f * _classes + c];
+            }
+        }
+    }
+}
+
+size_t AhoCorasick::write(std::ostream& out) const
+{
+    ImageHeader header{_classes, 0, _states, _phrases};
+    size_t bytes = writeSection(out, &header, sizeof(header));
+    bytes += writeSection(out, _classOf, ALPHABET);
+    bytes += writeSection(out, _next, _states * _classes * sizeof(uint32_t));
+    bytes += writeSection(out, _out, _states * sizeof(int32_t));
+    bytes += writeSection(out, _outLink, _states * sizeof(uint32_t));
+    bytes += writeSection(out, _points, _phrases * sizeof(int32_t));
+    return bytes;
+}
+
+void AhoCorasick::Scanner::reset()
+{
+    _state = ROOT;
+    _score = 0;
+    if (++_generation == 0)
+    {
+        //stamps wrapped around, old marks could look current
+        std::fill(_seen.begin(), _seen.end(), 0);
+        _generation = 1;
+    }
+}
+
+bool AhoCorasick::Scanner::feed(const char* data, size_t len, int threshold)
+{
+    const uint32_t* next = _ac->_next;
+    const unsigned char* classOf = _ac->_classOf;
+    size_t classes = _ac->_classes; //the table can pass 2^32 entries, offsets are size_t
+    uint32_t state = _state;
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        state = next[state * classes + classOf[(unsigned char) data[i]]];
+
+        //every phrase ending here - the state's own and those along its output links
+        for (uint32_t s = (_ac->_out[state] != NO_PATTERN) ? state : _ac->_outLink[state];
+             s != ROOT; s = _ac->_outLink[s])
+        {
+            int32_t phrase = _ac->_out[s];
+            if (_seen[phrase] != _generation)
+            {
+                _seen[phrase] = _generation;
+                _score += _ac->_points[phrase];
+            }
+        }
+        if (_score >= threshold)
+        {
+            _state = state;
+            return true;
+        }
+    }
+    _state = state;
+    return false;
+}
@@ -0,0 +1,168 @@
+#ifndef EX3_AHOCORASICK_H
+#define EX3_AHOCORASICK_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+#define ROOT 0
+#define NO_PATTERN -1
+#define ALPHABET 256
+#define SECTION_ALIGN 8
+
+/**
+ * aho-corasick automaton over a set of phrases. the goto and failure functions are resolved into
+ * one dense transition table (a row per state, a column per byte class), so scanning a message is
+ * a single table lookup per byte no matter how many phrases there are. ascii case is ignored.
+ * the tables are flat arrays, either owned (built from phrases) or viewed in place inside a
+ * compiled image, e.g. a mapped file.
+ */
+class AhoCorasick
+{
+private:
+    //owned storage, empty for a view
+    std::vector<unsigned char> _ownClassOf;
+    std::vector<uint32_t> _ownNext;
+    std::vector<int32_t> _ownOut;
+    std::vector<uint32_t> _ownOutLink;
+    std::vector<int32_t> _ownPoints;
+
+    uint32_t _classes;
+    size_t _states, _phrases;
+    const unsigned char* _classOf; //byte -> column, 0 for bytes that appear in no phrase
+    const uint32_t* _next;         //states x classes
+    const int32_t* _out;           //phrase ending at state, or NO_PATTERN
+    const uint32_t* _outLink;      //nearest proper suffix state with a phrase, ROOT if none
+    const int32_t* _points;        //per phrase
+
+    /**
+     * resolves failure links into the transition table, and builds output links
+     */
+    void _link();
+
+    /**
+     * points the table pointers at the owned storage
+     */
+    void _own();
+
+    /**
+     * maps ascii upper case letters to the columns of their lower case ones (unless phrases use
+     * them), so messages are scanned without lowercasing them first
+     */
+    void _foldCase();
+
+    /**
+     * checks that every entry of viewed tables is in range, throws std::invalid_argument otherwise
+     */
+    void _validate() const;
+
+public:
+    /**
+     * per message scan state. keeps the automaton state between calls, so a message can be fed
+     * in pieces, and counts every phrase at most once
+     */
+    class Scanner
+    {
+    private:
+        const AhoCorasick* _ac;
+        uint32_t _state;
+        int _score;
+        uint32_t _generation;
+        std::vector<uint32_t> _seen; //generation in which a phrase was last counted
+
+    public:
+        /**
+         * ctor
+         * @param ac
+         */
+        explicit Scanner(const AhoCorasick& ac) : _ac(&ac), _state(ROOT), _score(0), _generation(1),
+                                                  _seen(ac._phrases, 0)
+        {};
+
+        /**
+         * starts a new message, in O(1)
+         */
+        void reset();
+
+        /**
+         * scans more of the message
+         * @param data any bytes, ascii case is ignored
+         * @param len
+         * @param threshold stop once score reaches it
+         * @return true if score reached threshold
+         */
+        bool feed(const char* data, size_t len, int threshold);
+
+        /**
+         *
+         * @return sum of points of distinct phrases seen so far
+         */
+        int score() const
+        { return _score; }
+    };
+
+    /**
+     * ctor, builds the automaton
+     * @param phrases lowercased, non empty, distinct
+     * @param points points of each phrase
+     */
+    AhoCorasick(const std::vector<std::string>& phrases, const std::vector<int>& points);
+
+    /**
+     * ctor, views an image written by write() in place, only the byte class table is copied. the
+     * image must outlive the automaton. throws exception if the image is truncated
+     * @param image start of image, SECTION_ALIGN aligned
+     * @param len bytes available
+     */
+    AhoCorasick(const char* image, size_t len);
+
+    /**
+     * no copies, a view would point at the wrong storage
+     */
+    AhoCorasick(const AhoCorasick& other) = delete;
+
+    /**
+     * move ctor, vectors keep their buffers so the table pointers stay valid
+     * @param other
+     */
+    AhoCorasick(AhoCorasick && other) noexcept = default;
+
+    AhoCorasick& operator=(const AhoCorasick& other) = delete;
+
+    /**
+     * default dtor
+     */
+    ~AhoCorasick() = default;
+
+    /**
+     * writes the tables as an image for the view ctor
+     * @param out binary stream
+     * @return bytes written, a multiple of SECTION_ALIGN
+     */
+    size_t write(std::ostream& out) const;
+
+    /**
+     *
+     * @return num of automaton states
+     */
+    size_t states() const
+    { return _states; }
+
+    /**
+     *
+     * @return num of phrases
+     */
+    size_t phrases() const
+    { return _phrases; }
+
+    /**
+     *
+     * @param phrase index of phrase, as given to the ctor
+     * @return points of phrase
+     */
+    int points(size_t phrase) const
+    { return _points[phrase]; }
+};
+
+#endif //EX3_AHOCORASICK_H
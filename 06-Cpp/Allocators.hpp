@@ -0,0 +1,296 @@
+#ifndef EX3_ALLOCATORS_HPP
+#define EX3_ALLOCATORS_HPP
+
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#define ARENA_BLOCK (64 * 1024)
+#define POOL_MIN_SHIFT 4
+#define POOL_MAX_SHIFT 20
+
+/**
+ * monotonic memory resource - bump allocates from big blocks and frees nothing until release(),
+ * which drops everything in one shot. not thread safe
+ */
+class Arena
+{
+private:
+    struct block
+    {
+        void* p;
+        size_t align; //it was taken with, operator delete needs it back
+    };
+
+    std::vector<block> _blocks;
+    char* _cur;
+    size_t _left, _blockSize, _reserved;
+
+    /**
+     *
+     * @param size
+     * @param align power of 2, the block starts at a multiple of it
+     * @return new block taken from the heap
+     */
+    char* _newBlock(size_t size, size_t align)
+    {
+        align = std::max(align, size_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+        _blocks.reserve(_blocks.size() + 1);
+        char* b = static_cast<char*>(::operator new(size, std::align_val_t(align)));
+        _blocks.push_back({b, align});
+        _reserved += size;
+        return b;
+    }
+
+public:
+    /**
+     * ctor
+     * @param blockSize bytes taken from the heap at a time
+     */
+    explicit Arena(size_t blockSize = ARENA_BLOCK) : _cur(nullptr), _left(0), _blockSize(blockSize), _reserved(0)
+    {}
+
+    Arena(const Arena& other) = delete;
+
+    Arena& operator=(const Arena& other) = delete;
+
+    /**
+     * dtor, frees all blocks
+     */
+    ~Arena()
+    { release(); }
+
+    /**
+     *
+     * @param bytes
+     * @param align power of 2
+     * @return memory for bytes, valid until release()
+     */
+    void* allocate(size_t bytes, size_t align)
+    {
+        if (bytes > _blockSize / 2)
+        {
+            //big requests get a block of their own, so the current one is not wasted
+            return _newBlock(bytes, align);
+        }
+        size_t pad = (align - reinterpret_cast<uintptr_t>(_cur) % align) % align;
+        if (_cur == nullptr || pad + bytes > _left)
+        {
+            //a fresh block is aligned for this request, however far beyond max_align_t it goes
+            _cur = _newBlock(_blockSize, align);
+            _left = _blockSize;
+            pad = 0;
+        }
+        void* p = _cur + pad;
+        _cur += pad + bytes;
+        _left -= pad + bytes;
+        return p;
+    }
+
+    /**
+     * frees all memory given so far
+     */
+    void release()
+    {
+        for (const block& b : _blocks)
+        {
+            ::operator delete(b.p, std::align_val_t(b.align));
+        }
+        _blocks.clear();
+        _cur = nullptr;
+        _left = 0;
+        _reserved = 0;
+    }
+
+    /**
+     *
+     * @return bytes taken from the heap
+     */
+    size_t bytes() const
+    { return _reserved; }
+};
+
+/**
+ * size class pool - requests are rounded up to a power of 2 and freed blocks are kept on a free
+ * list per class for the next request of that class. blocks come from an arena, requests above
+ * 2^POOL_MAX_SHIFT bytes go to the heap. not thread safe
+ */
+class Pool
+{
+private:
+    Arena _arena;
+    void* _free[POOL_MAX_SHIFT + 1];
+
+    /**
+     *
+     * @param bytes at most 2^POOL_MAX_SHIFT
+     * @return smallest size class holding bytes
+     */
+    static int _class(size_t bytes)
+    {
+        int c = POOL_MIN_SHIFT;
+        while ((size_t(1) << c) < bytes)
+        {
+            ++c;
+        }
+        return c;
+    }
+
+public:
+    /**
+     * ctor
+     */
+    Pool() : _free()
+    {}
+
+    Pool(const Pool& other) = delete;
+
+    Pool& operator=(const Pool& other) = delete;
+
+    /**
+     *
+     * @param bytes
+     * @return memory for bytes, aligned for any fundamental type
+     */
+    void* allocate(size_t bytes)
+    {
+        if (bytes > (size_t(1) << POOL_MAX_SHIFT))
+        {
+            return ::operator new(bytes);
+        }
+        int c = _class(bytes);
+        void* p = _free[c];
+        if (p != nullptr)
+        {
+            _free[c] = *static_cast<void**>(p);
+            return p;
+        }
+        return _arena.allocate(size_t(1) << c, std::min(size_t(1) << c, alignof(std::max_align_t)));
+    }
+
+    /**
+     * gives a block back to its class
+     * @param p
+     * @param bytes size it was allocated with
+     */
+    void deallocate(void* p, size_t bytes)
+    {
+        if (bytes > (size_t(1) << POOL_MAX_SHIFT))
+        {
+            ::operator delete(p);
+            return;
+        }
+        int c = _class(bytes);
+        *static_cast<void**>(p) = _free[c];
+        _free[c] = p;
+    }
+
+    /**
+     * frees all memory of pooled classes in one shot
+     */
+    void release()
+    {
+        _arena.release();
+        std::fill(_free, _free + POOL_MAX_SHIFT + 1, nullptr);
+    }
+
+    /**
+     *
+     * @return bytes taken from the heap for pooled classes
+     */
+    size_t bytes() const
+    { return _arena.bytes(); }
+};
+
+/**
+ * std allocator over an Arena, deallocate is a no-op. copies share the arena
+ * @tparam T
+ */
+template<typename T>
+class ArenaAllocator
+{
+private:
+    Arena* _arena;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+     * ctor
+     * @param arena
+     */
+    explicit ArenaAllocator(Arena& arena) : _arena(&arena)
+    {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena())
+    {}
+
+    T* allocate(size_t n)
+    { return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T* p, size_t n)
+    { (void) p, (void) n; }
+
+    Arena* arena() const
+    { return _arena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    { return _arena == other.arena(); }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    { return _arena != other.arena(); }
+};
+
+/**
+ * std allocator over a size class Pool. copies share the pool
+ * @tparam T
+ */
+template<typename T>
+class PoolAllocator
+{
+private:
+    Pool* _pool;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+     * ctor
+     * @param pool
+     */
+    explicit PoolAllocator(Pool& pool) : _pool(&pool)
+    {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : _pool(other.pool())
+    {}
+
+    T* allocate(size_t n)
+    { return static_cast<T*>(_pool->allocate(n * sizeof(T))); }
+
+    void deallocate(T* p, size_t n)
+    { _pool->deallocate(p, n * sizeof(T)); }
+
+    Pool* pool() const
+    { return _pool; }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const
+    { return _pool == other.pool(); }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const
+    { return _pool != other.pool(); }
+};
+
+#endif //EX3_ALLOCATORS_HPP
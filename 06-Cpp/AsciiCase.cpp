@@ -0,0 +1,137 @@
+#include <cstring>
+#include "AsciiCase.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ASCII_X86
+#endif
+
+#define CASE_BIT 0x20
+
+/**
+ * kernel of toLower
+ */
+struct Kernel
+{
+    AsciiCase::Lower lower;
+    const char* name;
+};
+
+/**
+ * plain loop, also the tail of the vector kernels
+ * @param data
+ * @param len
+ */
+static void lowerScalar(char* data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        unsigned char c = data[i];
+        if ((unsigned char) (c - 'A') < 26)
+        {
+            data[i] = (char) (c | CASE_BIT);
+        }
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * 16 bytes a step. compares are signed, so bytes >= 0x80 are negative and never in 'A'..'Z'
+ * @param data
+ * @param len
+ */
+static void lowerSse2(char* data, size_t len)
+{
+    const __m128i below = _mm_set1_epi8('A' - 1), above = _mm_set1_epi8('Z' + 1), bit = _mm_set1_epi8(CASE_BIT);
+    size_t i = 0;
+    for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i))
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+        _mm_storeu_si128(p, _mm_or_si128(v, _mm_and_si128(upper, bit)));
+    }
+    lowerScalar(data + i, len - i);
+}
+#endif
+
+#if defined(ASCII_X86) && defined(__GNUC__)
+/**
+ * 32 bytes a step, built for avx2 whatever the target, and only run where the cpu has it
+ * @param data
+ * @param len
+ */
+__attribute__((target("avx2")))
+static void lowerAvx2(char* data, size_t len)
+{
+    const __m256i below = _mm256_set1_epi8('A' - 1), above = _mm256_set1_epi8('Z' + 1);
+    const __m256i bit = _mm256_set1_epi8(CASE_BIT);
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i))
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        __m256i v = _mm256_loadu_si256(p);
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v));
+        _mm256_storeu_si256(p, _mm256_or_si256(v, _mm256_and_si256(upper, bit)));
+    }
+    lowerScalar(data + i, len - i);
+}
+#endif
+
+/**
+ *
+ * @return best kernel the cpu runs
+ */
+static Kernel pickKernel()
+{
+#if defined(ASCII_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return Kernel{lowerAvx2, "avx2"};
+    }
+#endif
+#ifdef __SSE2__
+    return Kernel{lowerSse2, "sse2"};
+#else
+    return Kernel{lowerScalar, "scalar"};
+#endif
+}
+
+/**
+ *
+ * @return kernel picked on first use
+ */
+static const Kernel& kernelOf()
+{
+    static const Kernel kernel = pickKernel();
+    return kernel;
+}
+
+void AsciiCase::toLower(char* data, size_t len)
+{ kernelOf().lower(data, len); }
+
+AsciiCase::Lower AsciiCase::kernelNamed(const char* kernel)
+{
+    if (std::strcmp(kernel, "scalar") == 0)
+    {
+        return lowerScalar;
+    }
+#ifdef __SSE2__
+    if (std::strcmp(kernel, "sse2") == 0)
+    {
+        return lowerSse2;
+    }
+#endif
+#if defined(ASCII_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (std::strcmp(kernel, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+    {
+        return lowerAvx2;
+    }
+#endif
+    return nullptr;
+}
+
+const char* AsciiCase::kernel()
+{ return kernelOf().name; }
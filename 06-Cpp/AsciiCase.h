@@ -0,0 +1,38 @@
+#ifndef EX3_ASCIICASE_H
+#define EX3_ASCIICASE_H
+
+#include <cstddef>
+
+/**
+ * ascii case folding. only 'A'..'Z' change, every other byte (non ascii ones included) is kept,
+ * whatever the locale. the kernel is picked once by the cpu it runs on - avx2, sse2, or a plain
+ * loop
+ */
+class AsciiCase
+{
+public:
+    using Lower = void (*)(char*, size_t);
+
+    /**
+     * lowercases bytes in place, e.g. in a mapped buffer
+     * @param data
+     * @param len
+     */
+    static void toLower(char* data, size_t len);
+
+    /**
+     * a kernel by name instead of the picked one, e.g. to compare them
+     * @param kernel "avx2", "sse2" or "scalar"
+     * @return the kernel, lowercasing (data, len) in place, nullptr if this build or cpu has none
+     *         by that name
+     */
+    static Lower kernelNamed(const char* kernel);
+
+    /**
+     *
+     * @return name of the kernel toLower runs
+     */
+    static const char* kernel();
+};
+
+#endif //EX3_ASCIICASE_H
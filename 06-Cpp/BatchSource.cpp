@@ -0,0 +1,114 @@
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include "BatchSource.h"
+
+/**
+ *
+ * @param line
+ * @return true if line separates mbox messages
+ */
+static bool isFromLine(const std::string& line)
+{ return line.compare(0, sizeof(MBOX_FROM) - 1, MBOX_FROM) == 0; }
+
+/**
+ * ctor
+ * @param input
+ */
+BatchSource::BatchSource(const std::string& input) : _input(input), _nextFile(0), _stream(nullptr),
+                                                     _mbox(false), _hasPending(false), _count(0)
+{
+    std::error_code error;
+    if (std::filesystem::is_directory(input, error))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(input, error))
+        {
+            if (entry.is_regular_file())
+            {
+                _files.push_back(entry.path().string());
+            }
+        }
+        std::sort(_files.begin(), _files.end());
+        return;
+    }
+
+    if (input == STDIN_PATH)
+    {
+        _stream = &std::cin;
+    }
+    else
+    {
+        _file.reset(new std::ifstream(input));
+        if (!_file->good())
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+        _stream = _file.get();
+    }
+
+    //the first line tells an mbox from a list of paths
+    if (std::getline(*_stream, _pending))
+    {
+        _hasPending = true;
+        _mbox = isFromLine(_pending);
+    }
+}
+
+bool BatchSource::next(BatchItem& item)
+{
+    item.body.clear();
+    item.valid = item.spam = false;
+    item.score = 0;
+    item.evaluated = 0;
+
+    if (_stream == nullptr)
+    {
+        if (_nextFile == _files.size())
+        {
+            return false;
+        }
+        item.name = _files[_nextFile++];
+        item.loaded = false;
+        return true;
+    }
+
+    if (!_mbox)
+    {
+        //skip blank lines of the list
+        while (_hasPending && _pending.empty())
+        {
+            _hasPending = static_cast<bool>(std::getline(*_stream, _pending));
+        }
+        if (!_hasPending)
+        {
+            return false;
+        }
+        item.name = _pending;
+        item.loaded = false;
+        _hasPending = static_cast<bool>(std::getline(*_stream, _pending));
+        return true;
+    }
+
+    //mbox - _pending holds the "From " line of this message
+    if (!_hasPending)
+    {
+        return false;
+    }
+    item.name = _input + ":" + std::to_string(++_count);
+    item.loaded = true;
+    std::string line;
+    _hasPending = false;
+    while (std::getline(*_stream, line))
+    {
+        if (isFromLine(line))
+        {
+            _pending = line;
+            _hasPending = true;
+            break;
+        }
+        item.body += line;
+        item.body += '\n';
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef EX3_BATCHSOURCE_H
+#define EX3_BATCHSOURCE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+
+#define STDIN_PATH "-"
+#define MBOX_FROM "From "
+
+/**
+ * one message of a batch. messages of a directory or a file list are named by path and read by
+ * the worker that scores them, mbox messages come with their body already cut out of the stream
+ */
+struct BatchItem
+{
+    std::string name;
+    std::string body;
+    bool loaded;
+    bool valid;
+    bool spam;
+    int score;
+    size_t evaluated; //dictionary entries searched, scan mode only
+};
+
+/**
+ * reads the messages of a batch in input order. the input is either a directory (its regular
+ * files, sorted by name), an mbox stream (starts with a "From " line, messages are named
+ * <input>:<n>), or a list of message paths, one per line. "-" reads the list or mbox from stdin
+ */
+class BatchSource
+{
+private:
+    std::string _input;
+    std::vector<std::string> _files; //directory entries
+    size_t _nextFile;
+    std::unique_ptr<std::ifstream> _file;
+    std::istream* _stream;
+    bool _mbox;
+    std::string _pending; //first line of the next item
+    bool _hasPending;
+    size_t _count;
+
+public:
+    /**
+     * ctor, sniffs the input kind. throws exception if input cannot be read
+     * @param input
+     */
+    explicit BatchSource(const std::string& input);
+
+    /**
+     * reads the next message
+     * @param item set to next message, name and (for mbox) body
+     * @return false once input is exhausted
+     */
+    bool next(BatchItem& item);
+};
+
+#endif //EX3_BATCHSOURCE_H
@@ -0,0 +1,124 @@
+#ifndef EX3_BLOOMFILTER_HPP
+#define EX3_BLOOMFILTER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#define BLOOM_BITS_PER_KEY 10
+#define BLOOM_WORDS 8
+#define BLOOM_WORD_SHIFT 27
+
+/**
+ * split block bloom filter over full key hashes. a key sets one bit in each of the 8 words of a
+ * single 32 byte block, so adding and querying touch one cache line. bits are never removed,
+ * erased keys stay in until the filter is rebuilt. querying only reads, so any number of threads
+ * may query at once, the counters of a filtered map are kept with its telemetry
+ */
+class BloomFilter
+{
+private:
+    struct alignas(BLOOM_WORDS * sizeof(uint32_t)) Block
+    {
+        uint32_t words[BLOOM_WORDS];
+    };
+
+    std::vector<Block> _blocks;
+
+    /**
+     *
+     * @param hash
+     * @return hash with all bits mixed, std::hash of ints is the identity
+     */
+    static uint64_t _mix(uint64_t hash)
+    {
+        hash = (hash ^ (hash >> 33)) * 0xFF51AFD7ED558CCDULL;
+        hash = (hash ^ (hash >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+        return hash ^ (hash >> 33);
+    }
+
+    /**
+     *
+     * @param mixed mixed hash
+     * @return index of key's block
+     */
+    size_t _index(uint64_t mixed) const
+    { return ((mixed >> 32) * _blocks.size()) >> 32; }
+
+    /**
+     *
+     * @param mixed mixed hash
+     * @param word
+     * @return the bit key sets in given word of its block
+     */
+    static uint32_t _bit(uint64_t mixed, int word)
+    {
+        static const uint32_t salt[BLOOM_WORDS] = {0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+                                                   0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U};
+        return uint32_t(1) << ((static_cast<uint32_t>(mixed) * salt[word]) >> BLOOM_WORD_SHIFT);
+    }
+
+public:
+    /**
+     * ctor
+     * @param keys num of keys filter is sized for
+     */
+    explicit BloomFilter(size_t keys)
+    { reset(keys); }
+
+    /**
+     * drops all keys and resizes filter
+     * @param keys num of keys filter is sized for
+     */
+    void reset(size_t keys)
+    {
+        size_t bits = (keys == 0 ? 1 : keys) * BLOOM_BITS_PER_KEY;
+        size_t blockBits = BLOOM_WORDS * sizeof(uint32_t) * 8;
+        _blocks.assign((bits + blockBits - 1) / blockBits, Block{});
+    }
+
+    /**
+     * drops all keys
+     */
+    void clear()
+    { _blocks.assign(_blocks.size(), Block{}); }
+
+    /**
+     *
+     * @param hash full hash of key
+     */
+    void add(size_t hash)
+    {
+        uint64_t mixed = _mix(hash);
+        Block& b = _blocks[_index(mixed)];
+        for (int w = 0; w < BLOOM_WORDS; ++w)
+        {
+            b.words[w] |= _bit(mixed, w);
+        }
+    }
+
+    /**
+     *
+     * @param hash full hash of key
+     * @return false if key was surely never added
+     */
+    bool mayContain(size_t hash) const
+    {
+        uint64_t mixed = _mix(hash);
+        const Block& b = _blocks[_index(mixed)];
+        bool all = true;
+        for (int w = 0; w < BLOOM_WORDS; ++w)
+        {
+            all &= (b.words[w] & _bit(mixed, w)) != 0;
+        }
+        return all;
+    }
+
+    /**
+     *
+     * @return size of filter in bytes
+     */
+    size_t bytes() const
+    { return _blocks.size() * sizeof(Block); }
+};
+
+#endif //EX3_BLOOMFILTER_HPP
@@ -0,0 +1,10 @@
+#ifndef EX3_CACHELINE_HPP
+#define EX3_CACHELINE_HPP
+
+/**
+ * bytes of a cache line. state written by different threads is aligned to it, so those threads do
+ * not invalidate each other's lines (false sharing)
+ */
+#define CACHE_LINE 64
+
+#endif //EX3_CACHELINE_HPP
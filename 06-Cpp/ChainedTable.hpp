@@ -0,0 +1,354 @@
+#ifndef EX3_CHAINEDTABLE_HPP
+#define EX3_CHAINEDTABLE_HPP
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+/**
+ * chained storage for HashMap: an array of buckets, each bucket a vector of pairs.
+ * this is the original HashMap layout, kept as a policy for comparison. every pair is stored with
+ * the full hash of its key, compared before the key and reused when rehashing.
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Alloc allocator of the bucket array and of the buckets
+ */
+template<typename KeyT, typename ValueT, typename Alloc = std::allocator<std::pair<KeyT, ValueT>>>
+class ChainedTable
+{
+public:
+    using pair = std::pair<KeyT, ValueT>;
+
+    /**
+     * position of a pair - bucket index and index inside bucket
+     */
+    struct cursor
+    {
+        size_t bucket, index;
+
+        bool operator==(const cursor& other) const
+        { return bucket == other.bucket && index == other.index; }
+
+        bool operator!=(const cursor& other) const
+        { return !(*this == other); }
+    };
+
+private:
+    /**
+     * pair of a bucket, and its key's full hash
+     */
+    struct entry
+    {
+        size_t hash;
+        pair p;
+
+        template<typename... Args>
+        explicit entry(size_t h, Args&& ... args) : hash(h), p(std::forward<Args>(args)...)
+        {}
+    };
+
+    using entry_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<entry>;
+    using bucket = std::vector<entry, entry_alloc>;
+    using bucket_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<bucket>;
+    bucket_alloc _alloc;
+    size_t _capacity;
+    bucket* _buckets;
+
+    /**
+     * destroys all buckets and frees the array
+     */
+    void _release()
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            _buckets[i].~bucket();
+        }
+        if (_buckets != nullptr)
+        {
+            _alloc.deallocate(_buckets, _capacity);
+        }
+    }
+
+    /**
+     * moves cursor forward until it points to a pair (or to last())
+     * @param c
+     */
+    void _skipEmpty(cursor& c) const
+    {
+        while (c.bucket < _capacity && c.index >= _buckets[c.bucket].size())
+        {
+            ++c.bucket;
+            c.index = 0;
+        }
+    }
+
+public:
+    /**
+     * ctor
+     * @param capacity num of buckets, power of 2
+     * @param alloc
+     */
+    explicit ChainedTable(size_t capacity, const Alloc& alloc = Alloc()) :
+        _alloc(alloc), _capacity(capacity), _buckets(capacity == 0 ? nullptr : _alloc.allocate(capacity))
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            ::new((void*) &_buckets[i]) bucket(entry_alloc(_alloc));
+        }
+    }
+
+    /**
+     * no copies, HashMap copies pair by pair
+     */
+    ChainedTable(const ChainedTable& other) = delete;
+
+    /**
+     * move ctor
+     * @param other
+     */
+    ChainedTable(ChainedTable && other) noexcept : _alloc(other._alloc), _capacity(0), _buckets(nullptr)
+    { swap(other); }
+
+    /**
+     * dtor
+     */
+    ~ChainedTable()
+    { _release(); }
+
+    ChainedTable& operator=(const ChainedTable& other) = delete;
+
+    /**
+     * move operator=
+     * @param other
+     * @return
+     */
+    ChainedTable& operator=(ChainedTable && other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * swaps content with other table
+     * @param other
+     */
+    void swap(ChainedTable& other) noexcept
+    {
+        std::swap(_alloc, other._alloc);
+        std::swap(_capacity, other._capacity);
+        std::swap(_buckets, other._buckets);
+    }
+
+    /**
+     *
+     * @return num of buckets
+     */
+    size_t capacity() const
+    { return _capacity; }
+
+    /**
+     *
+     * @return always 0, chains leave nothing behind on erase
+     */
+    size_t tombstones() const
+    { return 0; }
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return pointer to pair of k, nullptr if k is not in table
+     */
+    template<typename K, typename Eq>
+    pair* find(const K& k, size_t hash, const Eq& eq) const
+    {
+        if (_capacity == 0)
+        {
+            return nullptr;
+        }
+        bucket& b = _buckets[hash & (_capacity - 1)];
+        for (entry& e : b)
+        {
+            if (e.hash == hash && eq(e.p.first, k))
+            {
+                return &e.p;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * starts loading the bucket of hash into cache, for a find or emplace coming soon
+     * @param hash
+     */
+    void prefetch(size_t hash) const
+    {
+        if (_capacity != 0)
+        {
+            __builtin_prefetch(_buckets + (hash & (_capacity - 1)), 1);
+        }
+    }
+
+    /**
+     * constructs a new pair in table. key must not be in table
+     * @param hash full hash of key
+     * @param args pair ctor args
+     * @return pointer to new pair
+     */
+    template<typename... Args>
+    pair* emplace(size_t hash, Args&& ... args)
+    {
+        bucket& b = _buckets[hash & (_capacity - 1)];
+        b.emplace_back(hash, std::forward<Args>(args)...);
+        return &b.back().p;
+    }
+
+    /**
+     * removes a pair found by find()
+     * @param p
+     * @param hash full hash of p's key
+     */
+    void erase(pair* p, size_t hash)
+    {
+        bucket& b = _buckets[hash & (_capacity - 1)];
+        auto it = b.begin();
+        while (&it->p != p)
+        {
+            ++it;
+        }
+        b.erase(it);
+    }
+
+    /**
+     * moves pairs out of a range of buckets, leaving them empty
+     * @param from first bucket of range, advanced past it
+     * @param n num of buckets to drain
+     * @param sink called with every pair of range as rvalue, and its full hash
+     */
+    template<typename Sink>
+    void drain(size_t& from, size_t n, Sink&& sink)
+    {
+        size_t end = std::min(_capacity, from + n);
+        for (; from < end; ++from)
+        {
+            for (entry& e : _buckets[from])
+            {
+                sink(std::move(e.p), e.hash);
+            }
+            _buckets[from] = bucket(entry_alloc(_alloc));
+        }
+    }
+
+    /**
+     *
+     * @param hash
+     * @return size of hash's bucket
+     */
+    size_t bucketSize(size_t hash) const
+    { return _buckets[hash & (_capacity - 1)].size(); }
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return num of pairs of hash's bucket passed before k, or the whole bucket if k is missing
+     */
+    template<typename K, typename Eq>
+    size_t probeLength(const K& k, size_t hash, const Eq& eq) const
+    {
+        if (_capacity == 0)
+        {
+            return 0;
+        }
+        const bucket& b = _buckets[hash & (_capacity - 1)];
+        size_t n = 0;
+        while (n < b.size() && !(b[n].hash == hash && eq(b[n].p.first, k)))
+        {
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     *
+     * @return bytes of table storage, bucket array and bucket contents
+     */
+    size_t bytes() const
+    {
+        size_t total = _capacity * sizeof(bucket);
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            total += _buckets[i].capacity() * sizeof(entry);
+        }
+        return total;
+    }
+
+    /**
+     * removes all pairs
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            _buckets[i].clear();
+        }
+    }
+
+    /**
+     *
+     * @return cursor to first pair
+     */
+    cursor first() const
+    {
+        cursor c{0, 0};
+        _skipEmpty(c);
+        return c;
+    }
+
+    /**
+     *
+     * @return cursor past last pair
+     */
+    cursor last() const
+    { return cursor{_capacity, 0}; }
+
+    /**
+     * advance cursor to next pair
+     * @param c
+     */
+    void next(cursor& c) const
+    {
+        ++c.index;
+        _skipEmpty(c);
+    }
+
+    /**
+     *
+     * @param c
+     * @return pair at cursor
+     */
+    pair& get(cursor c) const
+    { return _buckets[c.bucket][c.index].p; }
+
+    /**
+     *
+     * @param c
+     * @return full hash of pair at cursor
+     */
+    size_t hash(cursor c) const
+    { return _buckets[c.bucket][c.index].hash; }
+};
+
+/**
+ * layout tag for HashMap, separate chaining with a vector per bucket
+ */
+struct ChainedLayout
+{
+    template<typename KeyT, typename ValueT, typename Alloc>
+    using table = ChainedTable<KeyT, ValueT, Alloc>;
+};
+
+#endif //EX3_CHAINEDTABLE_HPP
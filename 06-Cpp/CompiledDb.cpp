@@ -0,0 +1,130 @@
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include "CompiledDb.h"
+
+/**
+ * fixed start of a compiled database
+ */
+struct DbHeader
+{
+    char magic[DB_MAGIC_LEN];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t phrases;
+    uint64_t textBytes;
+};
+
+/**
+ *
+ * @param bytes
+ * @return bytes rounded up to a whole section
+ */
+static size_t alignSection(size_t bytes)
+{ return (bytes + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN; }
+
+/**
+ * ctor, maps file and views its sections
+ * @param path
+ */
+CompiledDb::CompiledDb(const std::string& path) :
+    _file(path), _image(_locate(_file)), _phrases(reinterpret_cast<const DbHeader*>(_file.data())->phrases),
+    _offsets(reinterpret_cast<const uint64_t*>(_file.data() + sizeof(DbHeader))),
+    _text(_file.data() + sizeof(DbHeader) + alignSection((_phrases + 1) * sizeof(uint64_t))),
+    _automaton(_file.data() + _image, _file.size() - _image)
+{
+    //points are looked up by phrase index in the automaton
+    if (_automaton.phrases() != _phrases)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+}
+
+size_t CompiledDb::_locate(const MappedFile& file)
+{
+    if (file.size() < sizeof(DbHeader))
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    const DbHeader* header = reinterpret_cast<const DbHeader*>(file.data());
+    if (std::memcmp(header->magic, DB_MAGIC, DB_MAGIC_LEN) != 0 || header->version != DB_VERSION)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //phrases and textBytes are bounded by the file first, so the sizes below cannot overflow
+    size_t body = file.size() - sizeof(DbHeader);
+    if (header->phrases >= body / sizeof(uint64_t) || header->textBytes > body)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    size_t offsetsBytes = alignSection((header->phrases + 1) * sizeof(uint64_t));
+    size_t image = sizeof(DbHeader) + offsetsBytes + alignSection(header->textBytes);
+    if (image > file.size())
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //phrase i is text[offsets[i], offsets[i + 1]), so offsets must climb from 0 to textBytes
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file.data() + sizeof(DbHeader));
+    if (offsets[0] != 0 || offsets[header->phrases] != header->textBytes)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    for (size_t i = 0; i < header->phrases; ++i)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+    }
+    return image;
+}
+
+bool CompiledDb::isCompiled(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[DB_MAGIC_LEN] = {};
+    in.read(magic, DB_MAGIC_LEN);
+    return in.gcount() == DB_MAGIC_LEN && std::memcmp(magic, DB_MAGIC, DB_MAGIC_LEN) == 0;
+}
+
+int CompiledDb::write(const std::string& path, const std::vector<std::string>& phrases,
+                      const std::vector<int>& points)
+{
+    static const char pad[SECTION_ALIGN] = {};
+    AhoCorasick automaton(phrases, points);
+
+    std::vector<uint64_t> offsets;
+    offsets.reserve(phrases.size() + 1);
+    offsets.push_back(0);
+    for (const std::string& phrase : phrases)
+    {
+        offsets.push_back(offsets.back() + phrase.size());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.good())
+    {
+        return EXIT_FAILURE;
+    }
+
+    DbHeader header{};
+    std::memcpy(header.magic, DB_MAGIC, DB_MAGIC_LEN);
+    header.version = DB_VERSION;
+    header.phrases = phrases.size();
+    header.textBytes = offsets.back();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    size_t offsetsBytes = offsets.size() * sizeof(uint64_t);
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsetsBytes);
+    out.write(pad, alignSection(offsetsBytes) - offsetsBytes);
+    for (const std::string& phrase : phrases)
+    {
+        out.write(phrase.data(), phrase.size());
+    }
+    out.write(pad, alignSection(header.textBytes) - header.textBytes);
+
+    automaton.write(out);
+    return out.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,94 @@
+#ifndef EX3_COMPILEDDB_H
+#define EX3_COMPILEDDB_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "MappedFile.h"
+#include "AhoCorasick.h"
+
+#define DB_MAGIC "SPAMDB\0"
+#define DB_MAGIC_LEN 8
+#define DB_VERSION 1
+
+/**
+ * compiled bad words database - the validated, lowercased phrases and their prebuilt automaton
+ * in one versioned binary file. opening maps the file and views the tables in place, so nothing
+ * is parsed or copied at startup.
+ * layout: header, phrase offsets (phrases + 1), phrase text, automaton image. every section is
+ * SECTION_ALIGN aligned.
+ */
+class CompiledDb
+{
+private:
+    MappedFile _file;
+    size_t _image; //offset of automaton image
+    size_t _phrases;
+    const uint64_t* _offsets;
+    const char* _text;
+    AhoCorasick _automaton;
+
+    /**
+     * validates the header and sections of a mapped file
+     * @param file
+     * @return offset of the automaton image, throws exception if file is not a valid database
+     */
+    static size_t _locate(const MappedFile& file);
+
+public:
+    /**
+     * ctor, maps a compiled database. throws exception if file is missing or invalid
+     * @param path
+     */
+    explicit CompiledDb(const std::string& path);
+
+    /**
+     *
+     * @param path
+     * @return true if file starts with the compiled database magic
+     */
+    static bool isCompiled(const std::string& path);
+
+    /**
+     * compiles phrases and writes them as a database file
+     * @param path output file
+     * @param phrases lowercased, non empty, distinct
+     * @param points points of each phrase
+     * @return if process was successful
+     */
+    static int write(const std::string& path, const std::vector<std::string>& phrases,
+                     const std::vector<int>& points);
+
+    /**
+     *
+     * @return automaton over all phrases
+     */
+    const AhoCorasick& automaton() const
+    { return _automaton; }
+
+    /**
+     *
+     * @return num of phrases
+     */
+    size_t phrases() const
+    { return _phrases; }
+
+    /**
+     *
+     * @param i
+     * @return text of phrase i
+     */
+    std::string_view phrase(size_t i) const
+    { return std::string_view(_text + _offsets[i], _offsets[i + 1] - _offsets[i]); }
+
+    /**
+     *
+     * @param i
+     * @return points of phrase i
+     */
+    int points(size_t i) const
+    { return _automaton.points(i); }
+};
+
+#endif //EX3_COMPILEDDB_H
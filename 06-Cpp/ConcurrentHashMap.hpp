@@ -0,0 +1,246 @@
+#ifndef EX3_CONCURRENTHASHMAP_HPP
+#define EX3_CONCURRENTHASHMAP_HPP
+
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <shared_mutex>
+#include "HashMap.hpp"
+#include "CacheLine.hpp"
+
+#define SEGMENTS_I 64
+#define SEGMENT_MIX 0x9E3779B97F4A7C15ULL
+#define SEGMENT_HASH_BITS 64
+
+/**
+ * thread safe hashmap. the keys are striped over independent HashMap segments, each behind its
+ * own reader/writer lock and with its own resize, so threads working on different segments
+ * never wait for each other. values are returned by copy, since a reference would outlive the lock
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Layout storage policy of every segment
+ * @tparam Hash stateless hasher of keys, picks the segment and is passed on to the segments
+ * @tparam KeyEqual stateless key comparator
+ */
+template<typename KeyT, typename ValueT, typename Layout = FlatLayout, typename Hash = KeyHash<KeyT>,
+         typename KeyEqual = std::equal_to<>>
+class ConcurrentHashMap
+{
+private:
+    /**
+     * one stripe - lock and map, on its own cache line so segments do not false-share
+     */
+    struct alignas(CACHE_LINE) segment
+    {
+        mutable std::shared_mutex lock;
+        HashMap<KeyT, ValueT, Layout, Hash, KeyEqual> map;
+    };
+
+    size_t _count;
+    int _shift; //SEGMENT_HASH_BITS - log2(_count)
+    std::unique_ptr<segment[]> _segments;
+
+    /**
+     * picks segment by the top bits of the hash times a large odd constant, which depend on all of
+     * its bits. whatever bits a layout takes its bucket or tag from, and however a user hasher
+     * spreads its output, keys spread over all segments
+     * @param k
+     * @return segment of key
+     */
+    template<typename K>
+    segment& _segmentOf(const K& k) const
+    {
+        if (_count == 1)
+        {
+            return _segments[0];
+        }
+        uint64_t hash = Hash{}(k);
+        return _segments[(hash * SEGMENT_MIX) >> _shift];
+    }
+
+public:
+    /**
+     * ctor
+     * @param segments num of segments, rounded up to a power of 2
+     */
+    explicit ConcurrentHashMap(size_t segments = SEGMENTS_I) : _count(1), _shift(SEGMENT_HASH_BITS)
+    {
+        while (_count < segments)
+        {
+            _count *= 2;
+            --_shift;
+        }
+        _segments.reset(new segment[_count]);
+    }
+
+    /**
+     * no copies, segments hold locks
+     */
+    ConcurrentHashMap(const ConcurrentHashMap& other) = delete;
+
+    ConcurrentHashMap& operator=(const ConcurrentHashMap& other) = delete;
+
+    /**
+     * default dtor
+     */
+    ~ConcurrentHashMap() = default;
+
+    /**
+     *
+     * @return num of segments
+     */
+    size_t segments() const
+    { return _count; }
+
+    /**
+     *
+     * @param i segment index, below segments()
+     * @return num of values in segment i, to check how keys spread
+     */
+    int segmentSize(size_t i) const
+    {
+        std::shared_lock<std::shared_mutex> guard(_segments[i].lock);
+        return _segments[i].map.size();
+    }
+
+    /**
+     *
+     * @return num of values. segments are counted one after another, so concurrent writers can
+     * make it stale by the time it returns
+     */
+    int size() const
+    {
+        int total = 0;
+        for (size_t i = 0; i < _count; ++i)
+        {
+            std::shared_lock<std::shared_mutex> guard(_segments[i].lock);
+            total += _segments[i].map.size();
+        }
+        return total;
+    }
+
+    /**
+     *
+     * @return true if map is empty, false otherwise
+     */
+    bool empty() const
+    { return size() == 0; }
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @param v value of type ValueT
+     * @return true upon successful insertion to map, false otherwise
+     */
+    template<typename K, typename V>
+    bool insert(K&& k, V&& v)
+    {
+        segment& s = _segmentOf(k);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.try_emplace(KeyT(std::forward<K>(k)), std::forward<V>(v));
+    }
+
+    /**
+     * inserts pair, or assigns v to the existing value of k
+     * @param k key of type KeyT
+     * @param v value of type ValueT
+     * @return true if inserted, false if assigned
+     */
+    template<typename K, typename V>
+    bool insert_or_assign(K&& k, V&& v)
+    {
+        segment& s = _segmentOf(k);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.insert_or_assign(KeyT(std::forward<K>(k)), std::forward<V>(v));
+    }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @return if key in map
+     */
+    template<typename K>
+    bool containsKey(const K& k) const
+    {
+        segment& s = _segmentOf(k);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        return s.map.containsKey(k);
+    }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @param out set to value of key, if found
+     * @return if key in map
+     */
+    template<typename K>
+    bool tryGet(const K& k, ValueT& out) const
+    {
+        segment& s = _segmentOf(k);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        const ValueT* v = s.map.get(k);
+        if (v == nullptr)
+        {
+            return false;
+        }
+        out = *v;
+        return true;
+    }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @return copy of value of given key, throws exception if key is not in map
+     */
+    template<typename K>
+    ValueT at(const K& k) const
+    {
+        segment& s = _segmentOf(k);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        return s.map.at(k);
+    }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @return if value of give key was successfully removed
+     */
+    template<typename K>
+    bool erase(const K& k)
+    {
+        segment& s = _segmentOf(k);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.erase(k);
+    }
+
+    /**
+     * removes all elements in map
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < _count; ++i)
+        {
+            std::unique_lock<std::shared_mutex> guard(_segments[i].lock);
+            _segments[i].map.clear();
+        }
+    }
+
+    /**
+     * calls f on every pair, holding each segment's read lock while its pairs are visited
+     * @param f callable with const std::pair<KeyT, ValueT>&
+     */
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (size_t i = 0; i < _count; ++i)
+        {
+            std::shared_lock<std::shared_mutex> guard(_segments[i].lock);
+            for (const auto& p : _segments[i].map)
+            {
+                f(p);
+            }
+        }
+    }
+};
+
+#endif //EX3_CONCURRENTHASHMAP_HPP
@@ -0,0 +1,461 @@
+#ifndef EX3_DENSETABLE_HPP
+#define EX3_DENSETABLE_HPP
+
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#define DENSE_EMPTY UINT32_MAX
+#define DENSE_TAG_SHIFT 32
+
+/**
+ * dense storage for HashMap: pairs live packed in insertion order at the front of one array, with
+ * the full hash of every key in a parallel array. a separate index of slot numbers, probed
+ * linearly, maps hashes to pairs. every index slot holds a pair number and the high bits of its
+ * hash, so a probe only touches pairs whose bits match. walking the table is a plain sweep over
+ * live pairs, whatever the capacity. erase moves the last pair into the hole, and shifts the
+ * index back instead of leaving tombstones.
+ * rehashing drains pairs in order, so the new table keeps the order of the old one.
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Alloc allocator of the pair, hash and index arrays
+ */
+template<typename KeyT, typename ValueT, typename Alloc = std::allocator<std::pair<KeyT, ValueT>>>
+class DenseTable
+{
+public:
+    using pair = std::pair<KeyT, ValueT>;
+    using cursor = size_t;
+
+private:
+    /**
+     * index slot - pair number (DENSE_EMPTY if none), and high bits of its hash
+     */
+    struct slot
+    {
+        uint32_t entry;
+        uint32_t tag;
+    };
+
+    using pair_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<pair>;
+    using hash_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<size_t>;
+    using slot_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<slot>;
+    pair_alloc _alloc;
+    size_t _capacity;
+    size_t _count; //pairs [_drained, _count) are live
+    size_t _drained; //pairs drained from the front, their index slots are gone
+    slot* _index;
+    size_t* _hashes;
+    pair* _pairs;
+
+    /**
+     *
+     * @param hash
+     * @return tag of hash (its high bits, the low ones pick the home slot)
+     */
+    static uint32_t _tag(size_t hash)
+    { return (uint32_t) ((uint64_t) hash >> DENSE_TAG_SHIFT); }
+
+    /**
+     *
+     * @param e pair number
+     * @return index slot of pair
+     */
+    size_t _slotOf(size_t e) const
+    {
+        size_t mask = _capacity - 1;
+        size_t i = _hashes[e] & mask;
+        while (_index[i].entry != e)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    /**
+     * empties an index slot, shifting later slots of its run back so no probe passes a hole
+     * @param i
+     */
+    void _unindex(size_t i);
+
+    /**
+     * removes a pair, the last pair takes its place
+     * @param i index slot of pair
+     */
+    void _remove(size_t i);
+
+    /**
+     * destroys all pairs and frees storage
+     */
+    void _release();
+
+public:
+    /**
+     * ctor, throws exception if pair numbers do not fit the index
+     * @param capacity num of index slots and max num of pairs, power of 2
+     * @param alloc
+     */
+    explicit DenseTable(size_t capacity, const Alloc& alloc = Alloc());
+
+    /**
+     * no copies, HashMap copies pair by pair
+     */
+    DenseTable(const DenseTable& other) = delete;
+
+    /**
+     * move ctor
+     * @param other
+     */
+    DenseTable(DenseTable && other) noexcept : _alloc(other._alloc), _capacity(0), _count(0), _drained(0),
+                                               _index(nullptr), _hashes(nullptr), _pairs(nullptr)
+    { swap(other); }
+
+    /**
+     * dtor
+     */
+    ~DenseTable()
+    { _release(); }
+
+    DenseTable& operator=(const DenseTable& other) = delete;
+
+    /**
+     * move operator=
+     * @param other
+     * @return
+     */
+    DenseTable& operator=(DenseTable && other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * swaps content with other table
+     * @param other
+     */
+    void swap(DenseTable& other) noexcept
+    {
+        std::swap(_alloc, other._alloc);
+        std::swap(_capacity, other._capacity);
+        std::swap(_count, other._count);
+        std::swap(_drained, other._drained);
+        std::swap(_index, other._index);
+        std::swap(_hashes, other._hashes);
+        std::swap(_pairs, other._pairs);
+    }
+
+    /**
+     *
+     * @return num of index slots
+     */
+    size_t capacity() const
+    { return _capacity; }
+
+    /**
+     *
+     * @return always 0, erase shifts the index back
+     */
+    size_t tombstones() const
+    { return 0; }
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return pointer to pair of k, nullptr if k is not in table
+     */
+    template<typename K, typename Eq>
+    pair* find(const K& k, size_t hash, const Eq& eq) const;
+
+    /**
+     * starts loading the home index slot of hash into cache, for a find or emplace coming soon.
+     * new pairs go after the last one, which is in cache already
+     * @param hash
+     */
+    void prefetch(size_t hash) const
+    {
+        if (_capacity != 0)
+        {
+            __builtin_prefetch(_index + (hash & (_capacity - 1)), 1);
+        }
+    }
+
+    /**
+     * constructs a new pair after the last one. key must not be in table, and table must have a
+     * free slot
+     * @param hash full hash of key
+     * @param args pair ctor args
+     * @return pointer to new pair
+     */
+    template<typename... Args>
+    pair* emplace(size_t hash, Args&& ... args);
+
+    /**
+     * removes a pair found by find(). the last pair moves into its place
+     * @param p
+     * @param hash full hash of p's key
+     */
+    void erase(pair* p, size_t hash);
+
+    /**
+     * moves pairs out of table from the first one on, in order
+     * @param from advanced to the num of pairs drained, and to capacity() once table is empty
+     * @param n max num of pairs to drain
+     * @param sink called with every drained pair as rvalue, and its full hash
+     */
+    template<typename Sink>
+    void drain(size_t& from, size_t n, Sink&& sink);
+
+    /**
+     *
+     * @param hash
+     * @return num of occupied index slots from hash's home slot until the first empty one
+     */
+    size_t bucketSize(size_t hash) const;
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return num of index slots passed from hash's home slot before k, or before the first empty one
+     */
+    template<typename K, typename Eq>
+    size_t probeLength(const K& k, size_t hash, const Eq& eq) const;
+
+    /**
+     *
+     * @return bytes of table storage
+     */
+    size_t bytes() const
+    { return _capacity * (sizeof(slot) + sizeof(size_t) + sizeof(pair)); }
+
+    /**
+     * removes all pairs
+     */
+    void clear();
+
+    /**
+     *
+     * @return cursor to first pair
+     */
+    cursor first() const
+    { return _drained; }
+
+    /**
+     *
+     * @return cursor past last pair
+     */
+    cursor last() const
+    { return _count; }
+
+    /**
+     * advance cursor to next pair
+     * @param c
+     */
+    void next(cursor& c) const
+    { ++c; }
+
+    /**
+     *
+     * @param c
+     * @return pair at cursor
+     */
+    pair& get(cursor c) const
+    { return _pairs[c]; }
+
+    /**
+     *
+     * @param c
+     * @return full hash of pair at cursor
+     */
+    size_t hash(cursor c) const
+    { return _hashes[c]; }
+};
+
+/**
+ * layout tag for HashMap, pairs packed in insertion order behind an index
+ */
+struct DenseLayout
+{
+    template<typename KeyT, typename ValueT, typename Alloc>
+    using table = DenseTable<KeyT, ValueT, Alloc>;
+};
+
+template<typename KeyT, typename ValueT, typename Alloc>
+DenseTable<KeyT, ValueT, Alloc>::DenseTable(size_t capacity, const Alloc& alloc) :
+    _alloc(alloc), _capacity(capacity), _count(0), _drained(0), _index(nullptr), _hashes(nullptr), _pairs(nullptr)
+{
+    if (capacity >= DENSE_EMPTY)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    if (capacity == 0)
+    {
+        return;
+    }
+    _index = slot_alloc(_alloc).allocate(capacity);
+    _hashes = hash_alloc(_alloc).allocate(capacity);
+    _pairs = _alloc.allocate(capacity);
+    std::fill(_index, _index + _capacity, slot{DENSE_EMPTY, 0});
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void DenseTable<KeyT, ValueT, Alloc>::_release()
+{
+    if (_index == nullptr)
+    {
+        return;
+    }
+    clear();
+    _alloc.deallocate(_pairs, _capacity);
+    hash_alloc(_alloc).deallocate(_hashes, _capacity);
+    slot_alloc(_alloc).deallocate(_index, _capacity);
+    _index = nullptr;
+    _hashes = nullptr;
+    _pairs = nullptr;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename K, typename Eq>
+typename DenseTable<KeyT, ValueT, Alloc>::pair* DenseTable<KeyT, ValueT, Alloc>::find(const K& k, size_t hash,
+                                                                                      const Eq& eq) const
+{
+    uint32_t tag = _tag(hash);
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask;
+    for (size_t n = 0; n < _capacity && _index[i].entry != DENSE_EMPTY; ++n, i = (i + 1) & mask)
+    {
+        uint32_t e = _index[i].entry;
+        if (_index[i].tag == tag && _hashes[e] == hash && eq(_pairs[e].first, k))
+        {
+            return &_pairs[e];
+        }
+    }
+    return nullptr;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename... Args>
+typename DenseTable<KeyT, ValueT, Alloc>::pair* DenseTable<KeyT, ValueT, Alloc>::emplace(size_t hash,
+                                                                                         Args&& ... args)
+{
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask;
+    while (_index[i].entry != DENSE_EMPTY)
+    {
+        i = (i + 1) & mask;
+    }
+    size_t e = _count;
+    ::new((void*) &_pairs[e]) pair(std::forward<Args>(args)...);
+    _hashes[e] = hash;
+    _index[i] = slot{(uint32_t) e, _tag(hash)};
+    ++_count;
+    return &_pairs[e];
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void DenseTable<KeyT, ValueT, Alloc>::_unindex(size_t i)
+{
+    size_t mask = _capacity - 1;
+    size_t hole = i;
+    size_t j = (i + 1) & mask;
+    for (size_t n = 1; n < _capacity && _index[j].entry != DENSE_EMPTY; ++n, j = (j + 1) & mask)
+    {
+        //slot j may fill the hole only if the hole lies between j's home slot and j
+        size_t home = _hashes[_index[j].entry] & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            _index[hole] = _index[j];
+            hole = j;
+        }
+    }
+    _index[hole].entry = DENSE_EMPTY;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void DenseTable<KeyT, ValueT, Alloc>::_remove(size_t i)
+{
+    size_t e = _index[i].entry;
+    _unindex(i);
+    _pairs[e].~pair();
+
+    size_t last = _count - 1;
+    if (e != last)
+    {
+        _index[_slotOf(last)].entry = (uint32_t) e;
+        ::new((void*) &_pairs[e]) pair(std::move(_pairs[last]));
+        _hashes[e] = _hashes[last];
+        _pairs[last].~pair();
+    }
+    --_count;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void DenseTable<KeyT, ValueT, Alloc>::erase(pair* p, size_t hash)
+{
+    (void) hash;
+    _remove(_slotOf(p - _pairs));
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename Sink>
+void DenseTable<KeyT, ValueT, Alloc>::drain(size_t& from, size_t n, Sink&& sink)
+{
+    //pairs leave from the front and are not replaced, so the rest keep their order and numbers
+    size_t end = std::min(_count, _drained + n);
+    for (; _drained < end; ++_drained)
+    {
+        _unindex(_slotOf(_drained));
+        sink(std::move(_pairs[_drained]), _hashes[_drained]);
+        _pairs[_drained].~pair();
+    }
+    from = _drained == _count ? _capacity : _drained;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+size_t DenseTable<KeyT, ValueT, Alloc>::bucketSize(size_t hash) const
+{
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask, count = 0;
+    for (; count < _capacity && _index[i].entry != DENSE_EMPTY; i = (i + 1) & mask)
+    {
+        ++count;
+    }
+    return count;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename K, typename Eq>
+size_t DenseTable<KeyT, ValueT, Alloc>::probeLength(const K& k, size_t hash, const Eq& eq) const
+{
+    uint32_t tag = _tag(hash);
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask, n = 0;
+    for (; n < _capacity && _index[i].entry != DENSE_EMPTY; ++n, i = (i + 1) & mask)
+    {
+        uint32_t e = _index[i].entry;
+        if (_index[i].tag == tag && _hashes[e] == hash && eq(_pairs[e].first, k))
+        {
+            break;
+        }
+    }
+    return n;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void DenseTable<KeyT, ValueT, Alloc>::clear()
+{
+    for (size_t e = _drained; e < _count; ++e)
+    {
+        _pairs[e].~pair();
+    }
+    std::fill(_index, _index + _capacity, slot{DENSE_EMPTY, 0});
+    _count = 0;
+    _drained = 0;
+}
+
+#endif //EX3_DENSETABLE_HPP
@@ -0,0 +1,411 @@
+#ifndef EX3_FLATTABLE_HPP
+#define EX3_FLATTABLE_HPP
+
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define TAG_MASK 0x7F
+#define TAG_BITS 7
+
+/**
+ * open-addressing storage for HashMap (swiss-table style). every slot has a control byte which is
+ * either empty, deleted, or a 7 bit tag taken from the key's hash. pairs live in one flat array,
+ * with the full hash of every key kept beside them, so a probe walks the control bytes, and only
+ * compares keys whose tag and hash match. rehashing moves pairs by their stored hash.
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Alloc allocator of the slot and control arrays
+ */
+template<typename KeyT, typename ValueT, typename Alloc = std::allocator<std::pair<KeyT, ValueT>>>
+class FlatTable
+{
+public:
+    using pair = std::pair<KeyT, ValueT>;
+    using cursor = size_t;
+
+private:
+    using pair_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<pair>;
+    using ctrl_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<unsigned char>;
+    using hash_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<size_t>;
+    pair_alloc _alloc;
+    size_t _capacity, _deleted;
+    unsigned char* _ctrl;
+    size_t* _hashes; //full hash of the pair in every full slot
+    pair* _slots;
+
+    /**
+     *
+     * @param hash
+     * @return 7 bit tag of hash (its highest bits, the lowest ones pick the home slot)
+     */
+    static unsigned char _tag(size_t hash)
+    { return (unsigned char) ((hash >> (sizeof(size_t) * 8 - TAG_BITS)) & TAG_MASK); }
+
+    /**
+     *
+     * @param i slot index
+     * @return true if slot holds a pair
+     */
+    bool _full(size_t i) const
+    { return !(_ctrl[i] & CTRL_EMPTY); }
+
+    /**
+     * destroys all pairs and frees storage
+     */
+    void _release();
+
+public:
+    /**
+     * ctor
+     * @param capacity num of slots, power of 2
+     * @param alloc
+     */
+    explicit FlatTable(size_t capacity, const Alloc& alloc = Alloc());
+
+    /**
+     * no copies, HashMap copies pair by pair
+     */
+    FlatTable(const FlatTable& other) = delete;
+
+    /**
+     * move ctor
+     * @param other
+     */
+    FlatTable(FlatTable && other) noexcept : _alloc(other._alloc), _capacity(0), _deleted(0), _ctrl(nullptr),
+                                             _hashes(nullptr), _slots(nullptr)
+    { swap(other); }
+
+    /**
+     * dtor
+     */
+    ~FlatTable()
+    { _release(); }
+
+    FlatTable& operator=(const FlatTable& other) = delete;
+
+    /**
+     * move operator=
+     * @param other
+     * @return
+     */
+    FlatTable& operator=(FlatTable && other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * swaps content with other table
+     * @param other
+     */
+    void swap(FlatTable& other) noexcept
+    {
+        std::swap(_alloc, other._alloc);
+        std::swap(_capacity, other._capacity);
+        std::swap(_deleted, other._deleted);
+        std::swap(_ctrl, other._ctrl);
+        std::swap(_hashes, other._hashes);
+        std::swap(_slots, other._slots);
+    }
+
+    /**
+     *
+     * @return num of slots
+     */
+    size_t capacity() const
+    { return _capacity; }
+
+    /**
+     *
+     * @return num of deleted slots (tombstones) which still lengthen probes
+     */
+    size_t tombstones() const
+    { return _deleted; }
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return pointer to pair of k, nullptr if k is not in table
+     */
+    template<typename K, typename Eq>
+    pair* find(const K& k, size_t hash, const Eq& eq) const;
+
+    /**
+     * starts loading the home slot of hash into cache, for a find or emplace coming soon
+     * @param hash
+     */
+    void prefetch(size_t hash) const
+    {
+        if (_capacity == 0)
+        {
+            return;
+        }
+        size_t i = hash & (_capacity - 1);
+        __builtin_prefetch(_ctrl + i);
+        __builtin_prefetch(_hashes + i, 1);
+        __builtin_prefetch(_slots + i, 1);
+    }
+
+    /**
+     * constructs a new pair in table. key must not be in table, and table must have a free slot
+     * @param hash full hash of key
+     * @param args pair ctor args
+     * @return pointer to new pair
+     */
+    template<typename... Args>
+    pair* emplace(size_t hash, Args&& ... args);
+
+    /**
+     * removes a pair found by find()
+     * @param p
+     * @param hash full hash of p's key
+     */
+    void erase(pair* p, size_t hash);
+
+    /**
+     * moves pairs out of a range of slots. drained slots are left deleted, so probes of pairs still
+     * in table keep passing them
+     * @param from first slot of range, advanced past it
+     * @param n num of slots to drain
+     * @param sink called with every pair of range as rvalue, and its full hash
+     */
+    template<typename Sink>
+    void drain(size_t& from, size_t n, Sink&& sink);
+
+    /**
+     *
+     * @param hash
+     * @return num of occupied slots probed from hash's home slot until the first empty one
+     */
+    size_t bucketSize(size_t hash) const;
+
+    /**
+     *
+     * @param k key, or any type comparable to it
+     * @param hash full hash of k
+     * @param eq key comparator
+     * @return num of slots passed from hash's home slot before k, or before the first empty slot
+     */
+    template<typename K, typename Eq>
+    size_t probeLength(const K& k, size_t hash, const Eq& eq) const;
+
+    /**
+     *
+     * @return bytes of table storage
+     */
+    size_t bytes() const
+    { return _capacity * (sizeof(pair) + sizeof(size_t) + 1); }
+
+    /**
+     * removes all pairs
+     */
+    void clear();
+
+    /**
+     *
+     * @return cursor to first pair
+     */
+    cursor first() const
+    {
+        cursor c = 0;
+        while (c < _capacity && !_full(c))
+        {
+            ++c;
+        }
+        return c;
+    }
+
+    /**
+     *
+     * @return cursor past last pair
+     */
+    cursor last() const
+    { return _capacity; }
+
+    /**
+     * advance cursor to next pair
+     * @param c
+     */
+    void next(cursor& c) const
+    {
+        do
+        {
+            ++c;
+        } while (c < _capacity && !_full(c));
+    }
+
+    /**
+     *
+     * @param c
+     * @return pair at cursor
+     */
+    pair& get(cursor c) const
+    { return _slots[c]; }
+
+    /**
+     *
+     * @param c
+     * @return full hash of pair at cursor
+     */
+    size_t hash(cursor c) const
+    { return _hashes[c]; }
+};
+
+/**
+ * layout tag for HashMap, open addressing in one flat array
+ */
+struct FlatLayout
+{
+    template<typename KeyT, typename ValueT, typename Alloc>
+    using table = FlatTable<KeyT, ValueT, Alloc>;
+};
+
+template<typename KeyT, typename ValueT, typename Alloc>
+FlatTable<KeyT, ValueT, Alloc>::FlatTable(size_t capacity, const Alloc& alloc) :
+    _alloc(alloc), _capacity(capacity), _deleted(0),
+    _ctrl(capacity == 0 ? nullptr : ctrl_alloc(_alloc).allocate(capacity)),
+    _hashes(capacity == 0 ? nullptr : hash_alloc(_alloc).allocate(capacity)),
+    _slots(capacity == 0 ? nullptr : _alloc.allocate(capacity))
+{
+    std::fill(_ctrl, _ctrl + _capacity, CTRL_EMPTY);
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void FlatTable<KeyT, ValueT, Alloc>::_release()
+{
+    if (_ctrl == nullptr)
+    {
+        return;
+    }
+    clear();
+    _alloc.deallocate(_slots, _capacity);
+    hash_alloc(_alloc).deallocate(_hashes, _capacity);
+    ctrl_alloc(_alloc).deallocate(_ctrl, _capacity);
+    _ctrl = nullptr;
+    _hashes = nullptr;
+    _slots = nullptr;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename K, typename Eq>
+typename FlatTable<KeyT, ValueT, Alloc>::pair* FlatTable<KeyT, ValueT, Alloc>::find(const K& k, size_t hash,
+                                                                                    const Eq& eq) const
+{
+    unsigned char tag = _tag(hash);
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask;
+    for (size_t n = 0; n < _capacity && _ctrl[i] != CTRL_EMPTY; ++n, i = (i + 1) & mask)
+    {
+        if (_ctrl[i] == tag && _hashes[i] == hash && eq(_slots[i].first, k))
+        {
+            return &_slots[i];
+        }
+    }
+    return nullptr;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename... Args>
+typename FlatTable<KeyT, ValueT, Alloc>::pair* FlatTable<KeyT, ValueT, Alloc>::emplace(size_t hash, Args&& ... args)
+{
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask;
+    while (_full(i))
+    {
+        i = (i + 1) & mask;
+    }
+    ::new((void*) &_slots[i]) pair(std::forward<Args>(args)...);
+    if (_ctrl[i] == CTRL_DELETED)
+    {
+        --_deleted;
+    }
+    _ctrl[i] = _tag(hash);
+    _hashes[i] = hash;
+    return &_slots[i];
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void FlatTable<KeyT, ValueT, Alloc>::erase(pair* p, size_t hash)
+{
+    (void) hash;
+    size_t i = p - _slots;
+    p->~pair();
+
+    //no probe passes an empty slot, so if the next one is empty this one can be too
+    if (_ctrl[(i + 1) & (_capacity - 1)] == CTRL_EMPTY)
+    {
+        _ctrl[i] = CTRL_EMPTY;
+    }
+    else
+    {
+        _ctrl[i] = CTRL_DELETED;
+        ++_deleted;
+    }
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename Sink>
+void FlatTable<KeyT, ValueT, Alloc>::drain(size_t& from, size_t n, Sink&& sink)
+{
+    size_t end = std::min(_capacity, from + n);
+    for (; from < end; ++from)
+    {
+        if (_full(from))
+        {
+            sink(std::move(_slots[from]), _hashes[from]);
+            _slots[from].~pair();
+            _ctrl[from] = CTRL_DELETED;
+            ++_deleted;
+        }
+    }
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+size_t FlatTable<KeyT, ValueT, Alloc>::bucketSize(size_t hash) const
+{
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask, count = 0;
+    for (size_t n = 0; n < _capacity && _ctrl[i] != CTRL_EMPTY; ++n, i = (i + 1) & mask)
+    {
+        count += _full(i);
+    }
+    return count;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+template<typename K, typename Eq>
+size_t FlatTable<KeyT, ValueT, Alloc>::probeLength(const K& k, size_t hash, const Eq& eq) const
+{
+    unsigned char tag = _tag(hash);
+    size_t mask = _capacity - 1;
+    size_t i = hash & mask, n = 0;
+    for (; n < _capacity && _ctrl[i] != CTRL_EMPTY; ++n, i = (i + 1) & mask)
+    {
+        if (_ctrl[i] == tag && _hashes[i] == hash && eq(_slots[i].first, k))
+        {
+            break;
+        }
+    }
+    return n;
+}
+
+template<typename KeyT, typename ValueT, typename Alloc>
+void FlatTable<KeyT, ValueT, Alloc>::clear()
+{
+    for (size_t i = 0; i < _capacity; ++i)
+    {
+        if (_full(i))
+        {
+            _slots[i].~pair();
+        }
+        _ctrl[i] = CTRL_EMPTY;
+    }
+    _deleted = 0;
+}
+
+#endif //EX3_FLATTABLE_HPP
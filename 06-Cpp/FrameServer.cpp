@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include "FrameServer.h"
+
+#define LISTEN_ID 0
+#define WAKE_ID 1
+#define SIGNAL_ID 2
+#define FIRST_CONNECTION_ID 3
+#define READ_CHUNK (64 * 1024)
+
+/**
+ *
+ * @param path
+ * @param addr set to the socket address of path
+ * @return false if path is too long for a socket address
+ */
+static bool socketAddress(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/**
+ *
+ * @param body
+ * @return body as a frame
+ */
+static std::string frameOf(const std::string& body)
+{
+    std::string frame(FRAME_HEADER, '\0');
+    uint32_t len = (uint32_t) body.size();
+    for (int i = 0; i < FRAME_HEADER; ++i)
+    {
+        frame[i] = (char) (len >> (8 * (FRAME_HEADER - 1 - i)));
+    }
+    return frame + body;
+}
+
+/**
+ *
+ * @param p FRAME_HEADER bytes
+ * @return length in header
+ */
+static uint32_t lengthOf(const char* p)
+{
+    uint32_t len = 0;
+    for (int i = 0; i < FRAME_HEADER; ++i)
+    {
+        len = (len << 8) | (unsigned char) p[i];
+    }
+    return len;
+}
+
+/**
+ * registers fd with an epoll instance
+ * @param epollFd
+ * @param fd
+ * @param id event data
+ * @param events
+ * @return if process was successful
+ */
+static int watch(int epollFd, int fd, uint64_t id, uint32_t events)
+{
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = id;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int FrameServer::_watchSignals()
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGHUP);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    return signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+FrameServer::FrameServer(const std::string& path, size_t workers) :
+    _path(path), _listenFd(-1), _epollFd(-1), _wakeFd(-1), _signalFd(_watchSignals()), _pool(workers),
+    _nextId(FIRST_CONNECTION_ID), _reloading(false)
+{
+    sockaddr_un addr{};
+    if (_signalFd < 0 || !socketAddress(path, addr))
+    {
+        _release();
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    _listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    unlink(path.c_str());
+    if (_listenFd < 0 || _epollFd < 0 || _wakeFd < 0 ||
+        bind(_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(_listenFd, SERVER_BACKLOG) != 0 ||
+        watch(_epollFd, _listenFd, LISTEN_ID, EPOLLIN) == EXIT_FAILURE ||
+        watch(_epollFd, _wakeFd, WAKE_ID, EPOLLIN) == EXIT_FAILURE ||
+        watch(_epollFd, _signalFd, SIGNAL_ID, EPOLLIN) == EXIT_FAILURE)
+    {
+        _release();
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+}
+
+FrameServer::~FrameServer()
+{
+    _pool.wait();
+    if (_reloader.joinable())
+    {
+        _reloader.join();
+    }
+    _release();
+}
+
+void FrameServer::_release()
+{
+    std::vector<uint64_t> ids;
+    for (const auto & it : _connections)
+    {
+        ids.push_back(it.first);
+    }
+    for (uint64_t id : ids)
+    {
+        _close(id);
+    }
+    for (int fd : {_listenFd, _epollFd, _wakeFd, _signalFd})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+    if (_listenFd >= 0)
+    {
+        unlink(_path.c_str());
+    }
+    _listenFd = _epollFd = _wakeFd = _signalFd = -1;
+}
+
+void FrameServer::_accept()
+{
+    while (true)
+    {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return; //EAGAIN, or a client which already left
+        }
+        uint64_t id = _nextId++;
+        if (watch(_epollFd, fd, id, EPOLLIN | EPOLLRDHUP) == EXIT_FAILURE)
+        {
+            close(fd);
+            continue;
+        }
+        _connections.try_emplace(id, Connection{fd, "", "", false, false, false, false});
+    }
+}
+
+void FrameServer::_read(uint64_t id, const Handler& handler)
+{
+    Connection* c = _connections.get(id);
+    if (c == nullptr)
+    {
+        return;
+    }
+    char buf[READ_CHUNK];
+    while (c->in.size() < CONNECTION_IN_MAX)
+    {
+        ssize_t n = recv(c->fd, buf, std::min(sizeof(buf), (size_t) CONNECTION_IN_MAX - c->in.size()), 0);
+        if (n > 0)
+        {
+            c->in.append(buf, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n == 0)
+        {
+            //the client is done sending, but may still wait for the replies
+            c->ended = true;
+            break;
+        }
+        _close(id);
+        return;
+    }
+    _rearm(id, *c);
+    _dispatch(id, *c, handler);
+}
+
+void FrameServer::_dispatch(uint64_t id, Connection& c, const Handler& handler)
+{
+    if (c.busy || c.writing)
+    {
+        return;
+    }
+    uint32_t len = c.in.size() < FRAME_HEADER ? 0 : lengthOf(c.in.data());
+    if (len > FRAME_MAX)
+    {
+        _close(id);
+        return;
+    }
+    if (c.in.size() < FRAME_HEADER + (size_t) len)
+    {
+        //every whole request of an ended input is answered, a cut off one never completes
+        if (c.ended)
+        {
+            _close(id);
+        }
+        return;
+    }
+
+    std::string request = c.in.substr(FRAME_HEADER, len);
+    c.in.erase(0, FRAME_HEADER + (size_t) len);
+    c.busy = true;
+    _rearm(id, c);
+    _pool.submit([this, id, &handler, request = std::move(request)]() mutable
+                 {
+                     std::string reply;
+                     try
+                     {
+                         reply = handler(request);
+                     }
+                     catch (std::exception& e)
+                     {
+                         reply = "ERROR";
+                     }
+                     {
+                         std::lock_guard<std::mutex> guard(_lock);
+                         _replies.push_back(Reply{id, frameOf(reply)});
+                     }
+                     uint64_t one = 1;
+                     ssize_t n = write(_wakeFd, &one, sizeof(one));
+                     (void) n;
+                 });
+}
+
+bool FrameServer::_write(uint64_t id, Connection& c)
+{
+    size_t sent = 0;
+    while (sent < c.out.size())
+    {
+        ssize_t n = send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        _close(id);
+        return false;
+    }
+    c.out.erase(0, sent);
+    _rearm(id, c);
+    return true;
+}
+
+void FrameServer::_rearm(uint64_t id, Connection& c)
+{
+    //only ask for writability while output is stuck, or the loop would spin on it, and only for
+    //input while there is room for it and more can come
+    bool writing = !c.out.empty(), paused = c.ended || c.in.size() >= CONNECTION_IN_MAX;
+    if (writing != c.writing || paused != c.paused)
+    {
+        epoll_event ev{};
+        ev.events = (paused ? 0u : (uint32_t) (EPOLLIN | EPOLLRDHUP)) | (writing ? (uint32_t) EPOLLOUT : 0u);
+        ev.data.u64 = id;
+        epoll_ctl(_epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        c.writing = writing;
+        c.paused = paused;
+    }
+}
+
+void FrameServer::_deliver(const Handler& handler)
+{
+    uint64_t count;
+    ssize_t n = read(_wakeFd, &count, sizeof(count));
+    (void) n;
+    std::vector<Reply> replies;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        replies.swap(_replies);
+    }
+    for (Reply& reply : replies)
+    {
+        Connection* c = _connections.get(reply.id);
+        if (c == nullptr)
+        {
+            continue; //client left while its request was scored
+        }
+        c->out += reply.frame;
+        c->busy = false;
+        if (_write(reply.id, *c))
+        {
+            _dispatch(reply.id, *c, handler);
+        }
+    }
+}
+
+void FrameServer::_close(uint64_t id)
+{
+    Connection* c = _connections.get(id);
+    if (c == nullptr)
+    {
+        return;
+    }
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    _connections.erase(id);
+}
+
+void FrameServer::run(const Handler& handler, const std::function<void()>& reload)
+{
+    epoll_event events[SERVER_EVENTS];
+    bool stop = false;
+    while (!stop)
+    {
+        int n = epoll_wait(_epollFd, events, SERVER_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            uint64_t id = events[i].data.u64;
+            if (id == LISTEN_ID)
+            {
+                _accept();
+            }
+            else if (id == WAKE_ID)
+            {
+                _deliver(handler);
+            }
+            else if (id == SIGNAL_ID)
+            {
+                signalfd_siginfo info{};
+                while (read(_signalFd, &info, sizeof(info)) == (ssize_t) sizeof(info))
+                {
+                    if (info.ssi_signo != SIGHUP)
+                    {
+                        stop = true;
+                    }
+                    else if (!_reloading.exchange(true))
+                    {
+                        if (_reloader.joinable())
+                        {
+                            _reloader.join();
+                        }
+                        _reloader = std::thread([this, &reload]
+                                                {
+                                                    reload();
+                                                    _reloading = false;
+                                                });
+                    }
+                }
+            }
+            else
+            {
+                Connection* c = _connections.get(id);
+                if (c == nullptr)
+                {
+                    continue;
+                }
+                if (c->paused && (events[i].events & (EPOLLHUP | EPOLLERR)))
+                {
+                    //input is not watched while full or ended, this is the client gone or the socket failed
+                    _close(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT)
+                {
+                    if (!_write(id, *c))
+                    {
+                        continue;
+                    }
+                    //replies were stuck, a request may be waiting for them
+                    _dispatch(id, *c, handler);
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                {
+                    _read(id, handler);
+                }
+            }
+        }
+    }
+
+    //answer what is in flight before the handler goes away
+    _pool.wait();
+    if (_reloader.joinable())
+    {
+        _reloader.join();
+    }
+    _deliver(handler);
+}
+
+FrameClient::FrameClient(const std::string& path) : _fd(-1)
+{
+    sockaddr_un addr{};
+    if (!socketAddress(path, addr))
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    _fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_fd < 0 || connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        if (_fd >= 0)
+        {
+            close(_fd);
+        }
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+}
+
+FrameClient::~FrameClient()
+{ close(_fd); }
+
+bool FrameClient::call(const std::string& request, std::string& reply)
+{
+    std::string frame = frameOf(request);
+    size_t sent = 0;
+    while (sent < frame.size())
+    {
+        ssize_t n = send(_fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        sent += n;
+    }
+
+    //header first, then the body it announces
+    char header[FRAME_HEADER];
+    size_t got = 0;
+    size_t need = FRAME_HEADER;
+    char* dst = header;
+    for (int part = 0; part < 2; ++part)
+    {
+        while (got < need)
+        {
+            ssize_t n = recv(_fd, dst + got, need - got, 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            got += n;
+        }
+        if (part == 0)
+        {
+            need = lengthOf(header);
+            if (need > FRAME_MAX)
+            {
+                return false;
+            }
+            reply.resize(need);
+            dst = &reply[0];
+            got = 0;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,196 @@
+#ifndef EX3_FRAMESERVER_H
+#define EX3_FRAMESERVER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "HashMap.hpp"
+#include "WorkerPool.h"
+
+#define FRAME_HEADER 4
+#define FRAME_MAX (64 * 1024 * 1024)
+#define SERVER_BACKLOG 128
+#define SERVER_EVENTS 64
+#define CONNECTION_IN_MAX (FRAME_HEADER + FRAME_MAX)
+
+/**
+ * unix domain socket server of length prefixed frames - a 4 byte big endian length, then that many
+ * bytes. one thread runs an epoll loop over the listening socket and every connection, cuts
+ * request frames out of what it reads and hands them to a worker pool. replies come back to the
+ * loop, which writes them. a connection has one request in flight at a time, so its replies keep
+ * request order, while many connections are served at once. a connection buffers at most
+ * CONNECTION_IN_MAX bytes of requests not handed out yet, and is not read from while at that, nor
+ * handed more requests while its replies are not written - a client which sends without reading
+ * is slowed down, not buffered for. a client may shut down its side after its last request - what
+ * it sent is still answered, then the connection is closed.
+ * the loop also watches SIGHUP, which runs the reload callback on a thread of its own while
+ * requests keep being served, and SIGINT / SIGTERM, which stop it.
+ */
+class FrameServer
+{
+public:
+    /**
+     * called on a worker thread with a request body
+     * @return reply body
+     */
+    using Handler = std::function<std::string(std::string& request)>;
+
+private:
+    /**
+     * state of one client
+     */
+    struct Connection
+    {
+        int fd;
+        std::string in; //bytes read, not yet handed out as requests
+        std::string out; //reply bytes not yet written
+        bool busy; //a request is in flight
+        bool writing; //waiting for the socket to take more output
+        bool paused; //input is not watched - it is full until requests are handed out, or ended
+        bool ended; //the client shut down its side, no more input comes
+    };
+
+    /**
+     * reply of a worker, to be written by the loop
+     */
+    struct Reply
+    {
+        uint64_t id;
+        std::string frame;
+    };
+
+    std::string _path;
+    int _listenFd, _epollFd, _wakeFd, _signalFd;
+    WorkerPool _pool;
+    HashMap<uint64_t, Connection> _connections; //by id, ids below the first connection's are the fds above
+    uint64_t _nextId;
+    std::mutex _lock;
+    std::vector<Reply> _replies; //guarded by _lock
+    std::thread _reloader;
+    std::atomic<bool> _reloading;
+
+    /**
+     * blocks the signals the loop watches in the calling thread, so threads started from now on
+     * (the pool's) leave them to the loop
+     * @return signalfd for them
+     */
+    static int _watchSignals();
+
+    /**
+     * closes all connections and sockets, and removes the socket file
+     */
+    void _release();
+
+    /**
+     * accepts all pending connections
+     */
+    void _accept();
+
+    /**
+     * reads what a connection has, and hands out a request if one is complete
+     * @param id
+     * @param handler
+     */
+    void _read(uint64_t id, const Handler& handler);
+
+    /**
+     * hands the next complete request of a connection to the pool, unless one is in flight or
+     * replies are stuck. closes a connection whose input ended once nothing is left to answer
+     * @param id
+     * @param c
+     * @param handler
+     */
+    void _dispatch(uint64_t id, Connection& c, const Handler& handler);
+
+    /**
+     * writes as much pending output of a connection as the socket takes
+     * @param id
+     * @param c
+     * @return false if connection failed and was closed
+     */
+    bool _write(uint64_t id, Connection& c);
+
+    /**
+     * updates the events watched on a connection to its state - input unless it is full or ended,
+     * output while it is stuck
+     * @param id
+     * @param c
+     */
+    void _rearm(uint64_t id, Connection& c);
+
+    /**
+     * moves finished replies to their connections
+     * @param handler
+     */
+    void _deliver(const Handler& handler);
+
+    /**
+     * closes a connection, a reply still in flight is dropped
+     * @param id
+     */
+    void _close(uint64_t id);
+
+public:
+    /**
+     * ctor, binds and listens on path (replacing a stale socket file there). to be made before
+     * any other thread is started. throws exception if the socket cannot be set up
+     * @param path
+     * @param workers num of pool threads, 0 for one per core
+     */
+    FrameServer(const std::string& path, size_t workers);
+
+    FrameServer(const FrameServer& other) = delete;
+
+    FrameServer& operator=(const FrameServer& other) = delete;
+
+    /**
+     * dtor, closes all sockets and removes the socket file
+     */
+    ~FrameServer();
+
+    /**
+     * serves until SIGINT or SIGTERM. requests in flight then are still answered
+     * @param handler
+     * @param reload called on SIGHUP. a SIGHUP during a reload is ignored
+     */
+    void run(const Handler& handler, const std::function<void()>& reload);
+};
+
+/**
+ * blocking client of a FrameServer
+ */
+class FrameClient
+{
+private:
+    int _fd;
+
+public:
+    /**
+     * ctor, connects. throws exception if it cannot
+     * @param path
+     */
+    explicit FrameClient(const std::string& path);
+
+    FrameClient(const FrameClient& other) = delete;
+
+    FrameClient& operator=(const FrameClient& other) = delete;
+
+    /**
+     * dtor, disconnects
+     */
+    ~FrameClient();
+
+    /**
+     * sends a request and waits for its reply
+     * @param request
+     * @param reply
+     * @return false if the connection failed
+     */
+    bool call(const std::string& request, std::string& reply);
+};
+
+#endif //EX3_FRAMESERVER_H
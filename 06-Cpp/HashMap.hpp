@@ -1,617 +1,1154 @@
-#ifndef EX3_HASHMAP_HPP
-#define EX3_HASHMAP_HPP
-
-#include <vector>
-#include <string>
-#include <exception>
-#include <iostream>
-
-#define CAP_I 16
-#define SIZE_I 0
-#define FACTOR 2
-#define LOWER_I (1/4.0)
-#define UPPER_I (3/4.0)
-#define UPSIZE 1
-#define DOWNSIZE -1
-
-/**
- * hashmap class
- * @tparam KeyT
- * @tparam ValueT
- */
-template<typename KeyT, typename ValueT>
-class HashMap
-{
-private:
-    size_t _size, _capacity;
-    using pair = std::pair<KeyT, ValueT>;
-    using bucket = std::vector<pair>;
-    double _low_factor, _up_factor;
-    bucket* _map;
-
-    /**
-     * resizing map
-     * @param sign >0 upon upsize, <0 upon downsize
-     */
-    void _resize(int sign);
-
-    /**
-     *
-     * @param k
-     * @return bucket index (using std::hash)
-     */
-    size_t _getBucketIndex(const KeyT& k) const
-    { return (std::hash<KeyT>{}(k) & (_capacity - 1)); }
-
-    /**
-     *
-     * @param k
-     * @return pair index of key
-     */
-    size_t _getPairIndex(const KeyT& k) const;
-
-public:
-    /**
-     * default ctor
-     */
-    HashMap() : _size(SIZE_I), _capacity(CAP_I), _low_factor(LOWER_I), _up_factor(UPPER_I),
-                _map(new bucket[_capacity]) {};
-
-    /**
-     * ctr1, gets upper & lower thresholds for hashmap size
-     * @param upper
-     * @param lower
-     */
-    HashMap(double upper, double lower);
-
-    /**
-     * ctor2, gets vectors of keys and values and keep them in map
-     * @param keys
-     * @param values
-     */
-    HashMap(const std::vector<KeyT>& keys, const std::vector<ValueT>& values);
-
-    /**
-     * copy ctor
-     * @param other
-     */
-    HashMap(const HashMap& other) : _size(SIZE_I), _capacity(other.capacity()),
-                                    _low_factor(other._low_factor), _up_factor(other._up_factor),
-                                    _map(new bucket[_capacity])
-    {
-        //perform deep copy
-        for (auto it = other.cbegin(); it != cend(); ++it)
-        {
-            insert((*it).first, (*it).second);
-        }
-    }
-
-    /**
-     * move ctor
-     * @param other
-     */
-    HashMap(HashMap && other) noexcept : _size(other._size), _capacity(other.capacity()),
-                                        _low_factor(other._low_factor), _up_factor(other._up_factor),
-                                        _map(nullptr)
-    { std::swap(_map, other._map); }
-
-    /**
-     * dtor
-     */
-    ~HashMap()
-    { delete[] _map; };
-
-    /**
-     *
-     * @return current size of map (num of values)
-     */
-    int size() const
-    { return _size; }
-
-    /**
-     *
-     * @return hashmap capacity
-     */
-    int capacity() const
-    { return _capacity; }
-
-    /**
-     *
-     * @return current load factor
-     */
-    double getLoadFactor() const
-    { return (size() / capacity()); }
-
-    /**
-     *
-     * @return true if map is empty, false otherwise
-     */
-    bool empty() const
-    { return size() == 0; }
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @param v value of type ValueT
-     * @return true upon successful insertion to map, false otherwise
-     */
-    bool insert(const KeyT& k, const ValueT& v);
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return if key in map
-     */
-    bool containsKey(const KeyT& k) const;
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return value of given key, throws exception if key is not in map
-     */
-    ValueT& at(const KeyT& k) const;
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return if value of give key was successfully removed
-     */
-    bool erase(const KeyT& k);
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return size of bucket
-     */
-    int bucketSize(const KeyT& k) const;
-
-    /**
-     * removes all elements in map
-     */
-    void clear();
-
-    /**
-     * copy operator=
-     * @param other
-     * @return reference to hashmap
-     */
-    HashMap& operator=(const HashMap& other)
-    {
-        _size = SIZE_I;
-        _capacity = other.capacity();
-        _low_factor = other._low_factor;
-        _up_factor = other._up_factor;
-        _map = new bucket[_capacity];
-
-        //perform deep copy
-        for (auto it = other.cbegin(); it != cend(); ++it)
-        {
-            insert(it->first, it->second);
-        }
-    }
-
-    /**
-     * move operator=
-     * @param other
-     * @return
-     */
-    HashMap& operator=(HashMap && other) noexcept
-    {
-        _size = other._size;
-        _capacity = other.capacity();
-        _low_factor = other._low_factor;
-        _up_factor = other._up_factor;
-        _map(nullptr);
-        std::swap(_map, other._map);
-    }
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return value of given key in map
-     */
-    const ValueT& operator[](const KeyT& k) const noexcept;
-
-    /**
-     *
-     * @param k key of type KeyT
-     * @return assigning value of given key in map
-     */
-    ValueT& operator[](KeyT k) noexcept;
-
-    /**
-     *
-     * @param other
-     * @return true if maps are the same, false otherwise
-     */
-    bool operator==(const HashMap& other) const;
-
-    /**
-     *
-     * @param other
-     * @return true if maps are different, false otherwise
-     */
-    bool operator!=(const HashMap& other) const
-    { return !(*this == other); }
-
-    // ************** const_iterator ************** //
-    /**
-     * HashMap iterator
-     */
-    class const_iterator
-    {
-    private:
-        bucket* _pBucket;
-        int _capacity;
-        int _cur_bucket;
-        typename bucket::iterator _it;
-    public:
-        /**
-         * default ctor
-         */
-        explicit const_iterator(bucket* p, int capacity, int bucket_index = 0) :
-            _pBucket(p), _capacity(capacity), _cur_bucket(bucket_index), _it((*_pBucket).begin())
-        {
-            if (bucket_index == capacity)
-            {
-                _it = p[capacity - 1].end();
-            }
-            while (_cur_bucket < _capacity - 1 && _it == _pBucket[_cur_bucket].end())
-            {
-                ++_cur_bucket;
-                _it = _pBucket[_cur_bucket].begin();
-            }
-        };
-
-        /**
-         * dereference operator for reading
-         * @return value of obj
-         */
-        const std::pair<KeyT, ValueT>& operator*() const
-        { return *_it; }
-
-        /**
-         * pre-increment
-         * @return
-         */
-        const_iterator& operator++()
-        {
-            if (_cur_bucket == _capacity)
-            {
-                _it = _pBucket[_capacity - 1].end();
-                return *this;
-            }
-
-            if (_it != _pBucket[_cur_bucket].end())
-            {
-                ++_it;
-            }
-            while (_cur_bucket < _capacity - 1 && _it == _pBucket[_cur_bucket].end())
-            {
-                ++_cur_bucket;
-                _it = _pBucket[_cur_bucket].begin();
-            }
-            return *this;
-        }
-
-        /**
-         * post-increment
-         * @return
-         */
-        const_iterator& operator++(int)
-        {
-            auto result = *this;
-            ++(*this);
-            return result;
-        }
-
-        /**
-         *
-         * @param other
-         * @return true if 2 iterators point to same obj, false otherwise
-         */
-        bool operator==(const const_iterator& other) const
-        { return _it == other._it; }
-
-        /**
-         *
-         * @param other
-         * @return true if 2 iterators point to different obj, false otherwise
-         */
-        bool operator!=(const const_iterator& other) const
-        { return !(*this == other); }
-    };
-
-    /**
-    *
-    * @return iterator to first pair in map
-    */
-    const_iterator begin() const
-    { return const_iterator(_map, capacity()); }
-
-    /**
-     *
-     * @return iterator that indicates end of objects in map
-     */
-    const_iterator end() const
-    { return const_iterator(_map, capacity(), capacity()); }
-
-    /**
-     *
-     * @return iterator to first pair in map
-     */
-    const_iterator cbegin() const
-    { return const_iterator(_map, capacity()); }
-
-    /**
-     *
-     * @return iterator that indicates end of objects in map
-     */
-    const_iterator cend() const
-    { return const_iterator(_map, capacity(), capacity()); }
-};
-
-/**
- * ctor with upper and lower load factors
- * @tparam KeyT
- * @tparam ValueT
- * @param upper
- * @param lower
- */
-template<typename KeyT, typename ValueT>
-HashMap<KeyT, ValueT>::HashMap(double upper, double lower)
-{
-    if (upper < 0 || upper > 1 || lower < 0 || lower > 1 || upper < lower)
-    {
-        std::cerr << "exiting ctor due to illegal params\n";
-        throw std::invalid_argument("exiting ctor due to illegal params\n");
-    }
-    HashMap(), _low_factor = lower, _up_factor = upper;
-}
-
-/**
- * inserts new pait to map
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @param v
- * @return true upon success
- */
-template<typename KeyT, typename ValueT>
-bool HashMap<KeyT, ValueT>::insert(const KeyT& k, const ValueT& v)
-{
-    if (containsKey(k))
-    {
-        return false;
-    }
-    ++_size; _resize(UPSIZE);
-    size_t index = _getBucketIndex(k);
-    _map[index].push_back(std::make_pair(k, v));
-    return true;
-}
-
-/**
- * erase a pair by key
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @return true upon success
- */
-template<typename KeyT, typename ValueT>
-bool HashMap<KeyT, ValueT>::erase(const KeyT& k)
-{
-    if (!containsKey(k))
-    {
-        return false;
-    }
-    _map[_getBucketIndex(k)].erase(_map[_getBucketIndex(k)].cbegin() + _getPairIndex(k));
-    --_size; _resize(DOWNSIZE);
-    return true;
-}
-
-/**
- * resizing map
- * @tparam KeyT
- * @tparam ValueT
- * @param sign indicates if upsize/downsize
- */
-template<typename KeyT, typename ValueT>
-void HashMap<KeyT, ValueT>::_resize(int sign)
-{
-    if ((sign == UPSIZE && getLoadFactor() > _up_factor) ||
-        (sign == DOWNSIZE && getLoadFactor() < _low_factor))
-    {
-        //hold all obj to be inserted
-        std::vector<pair> all;
-        all.reserve(_size);
-        for (auto it = cbegin(); it != cend(); ++it)
-        {
-            all.push_back(*it);
-        }
-
-        //create new map
-        _capacity = (sign == UPSIZE) ? (_capacity * FACTOR) : (_capacity / FACTOR);
-        delete[] _map;
-        _map = new bucket[_capacity];
-        _size = 0;
-        for (auto it = all.cbegin(); it != all.cend(); ++it)
-        {
-            insert(it->first, it->second);
-        }
-    }
-}
-
-/**
- *
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @return true if key in map, false otherwise
- */
-template<typename KeyT, typename ValueT>
-bool HashMap<KeyT, ValueT>::containsKey(const KeyT& k) const
-{
-    if (empty())
-    {
-        return false;
-    }
-
-    int hash = _getBucketIndex(k);
-    bucket b = _map[hash];
-    for (int i = 0; i < (int) b.size(); ++i)
-    {
-        if (b[i].first == k)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
-/**
- * ctor with given keys anf values
- * @tparam KeyT
- * @tparam ValueT
- * @param keys
- * @param values
- */
-template<typename KeyT, typename ValueT>
-HashMap<KeyT, ValueT>::HashMap(const std::vector<KeyT>& keys, const std::vector<ValueT>& values)
-{
-    try
-    {
-        if (keys.size() != values.size())
-        {
-            throw std::invalid_argument("exiting ctor due to illegal params\n");
-        }
-        HashMap();
-        for (int i = 0; i < keys.size(); ++i)
-        {
-            if (!insert(keys[i], values[i]))
-            {
-                int b = _getBucketIndex(keys[i]);
-                int p = _getPairIndex(keys[i]);
-                _map[b][p] = std::pair<KeyT, ValueT>(keys[i], values[i]);
-            }
-        }
-    }
-    catch (std::invalid_argument& e)
-    {
-        std::cerr << "exiting ctor due to illegal params\n";
-        throw;
-    }
-}
-
-/**
- *
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @return size of given key's bucket
- */
-template<typename KeyT, typename ValueT>
-int HashMap<KeyT, ValueT>::bucketSize(const KeyT& k) const
-{
-    if (!containsKey(k))
-    {
-        std::cerr << "exiting bucketsize() due to exception\n";
-        throw std::out_of_range("exiting bucketsize() due to exception\n");
-    }
-    return _map[_getBucketIndex(k)].size();
-}
-
-/**
- * operator [] for reading
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @return
- */
-template<typename KeyT, typename ValueT>
-const ValueT& HashMap<KeyT, ValueT>::operator[](const KeyT& k) const noexcept
-{
-    ValueT undefined;
-    if (!containsKey(k)) return undefined; //undefined
-    return _map[_getBucketIndex(k)][_getPairIndex(k)].second;
-}
-
-/**
- * operator [] for writing
- * @tparam KeyT
- * @tparam ValueT
- * @param k
- * @return
- */
-template<typename KeyT, typename ValueT>
-ValueT& HashMap<KeyT, ValueT>::operator[](KeyT k) noexcept
-{
-    if (!containsKey(k))
-    {
-        insert(k, ValueT());
-    }
-
-    return _map[_getBucketIndex(k)][_getPairIndex(k)].second;
-}
-
-
-template<typename KeyT, typename ValueT>
-void HashMap<KeyT, ValueT>::clear()
-{
-    for (int i = 0; i < capacity(); ++i)
-    {
-        _map[i].clear();
-    }
-    _size = 0;
-}
-
-template<typename KeyT, typename ValueT>
-ValueT& HashMap<KeyT, ValueT>::at(const KeyT& k) const
-{
-    int hash = _getBucketIndex(k);
-    bucket b = _map[hash];
-    for (int i = 0; i < b.size(); ++i)
-    {
-        if (b[i].first == k)
-        {
-            return b[i].second;
-        }
-    }
-    std::cerr << "exiting at() due to exception\n";
-    throw std::out_of_range("exiting at() due to exception\n");
-}
-
-template<typename KeyT, typename ValueT>
-bool HashMap<KeyT, ValueT>::operator==(const HashMap& other) const
-{
-    if (size() != other.size() || capacity() != other.capacity() ||
-        _low_factor != other._low_factor || _up_factor != other._up_factor)
-    {
-        return false;
-    }
-
-    for (auto it = cbegin(); it != cend(); ++it)
-    {
-        KeyT key = (*it).first;
-        if (!containsKey(key) || (at(key) != other.at(key)))
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-template<typename KeyT, typename ValueT>
-size_t HashMap<KeyT, ValueT>::_getPairIndex(const KeyT& k) const
-{
-    bucket b = _map[_getBucketIndex(k)];
-    for (int i = 0; i < b.size(); ++i)
-    {
-        if (b[i].first == k)
-        {
-            return i;
-        }
-    }
-    throw std::out_of_range("exiting inner func _getPairIndex due to exception\n");
-}
-
-#endif //EX3_HASHMAP_HPP
+#ifndef EX3_HASHMAP_HPP
+#define EX3_HASHMAP_HPP
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+#include "FlatTable.hpp"
+#include "ChainedTable.hpp"
+#include "DenseTable.hpp"
+#include "KeyHash.hpp"
+#include "BloomFilter.hpp"
+#include "HashMapStats.hpp"
+
+#define CAP_I 16
+#define SIZE_I 0
+#define FACTOR 2
+#define LOWER_I (1/4.0)
+#define UPPER_I (3/4.0)
+#define UPSIZE 1
+#define DOWNSIZE -1
+#define BULK_AHEAD 8
+
+/**
+ * hashmap class
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Layout storage policy - FlatLayout (open addressing, default), ChainedLayout, or DenseLayout
+ * (insertion ordered, fastest to iterate)
+ * @tparam Hash stateless hasher of keys, full 64 bit output (StringHash for strings by default)
+ * @tparam KeyEqual stateless key comparator
+ * @tparam Alloc allocator of table storage, e.g. ArenaAllocator or PoolAllocator (Allocators.hpp)
+ */
+template<typename KeyT, typename ValueT, typename Layout = FlatLayout, typename Hash = KeyHash<KeyT>,
+         typename KeyEqual = std::equal_to<>, typename Alloc = std::allocator<std::pair<KeyT, ValueT>>>
+class HashMap
+{
+private:
+    using table = typename Layout::template table<KeyT, ValueT, Alloc>;
+    using pair = std::pair<KeyT, ValueT>;
+    using cursor = typename table::cursor;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    /**
+     * enables lookup by K - always for KeyT itself, and for any K the hasher and comparator accept
+     * if both are transparent (std::string_view or const char* for string keys)
+     */
+    template<typename K>
+    using LookupKey = std::enable_if_t<std::is_same<K, KeyT>::value ||
+                                       (IsTransparent<hasher>::value && IsTransparent<key_equal>::value)>;
+    size_t _size;
+    double _low_factor, _up_factor;
+    Alloc _alloc;
+    table _map;
+    table _old; //table being migrated into _map, empty when no rehash is in progress
+    size_t _migrated, _rehash_step;
+    std::unique_ptr<BloomFilter> _filter; //negative prefilter of lookups, null when off
+#ifdef HASHMAP_STATS
+    mutable HashMapStats _stats;
+#endif
+
+    /**
+     * resizing map
+     * @param sign >0 upon upsize, <0 upon downsize
+     */
+    void _resize(int sign);
+
+    /**
+     * starts moving pairs to a new table. the move finishes right away unless incremental rehash
+     * is on, in which case each mutating operation moves a few more buckets
+     * @param capacity of new table
+     */
+    void _rehash(size_t capacity);
+
+    /**
+     * moves buckets of _old into _map, and drops _old once it is empty
+     * @param buckets max num of buckets to move
+     */
+    void _migrate(size_t buckets);
+
+    /**
+     *
+     * @return true if a table is still being migrated
+     */
+    bool _migrating() const
+    { return _old.capacity() != 0; }
+
+    /**
+     * refills the prefilter with every key, sized for the keys capacity holds before next upsize
+     * @param capacity of current table
+     */
+    void _rebuildFilter(size_t capacity);
+
+    /**
+     *
+     * @param n num of pairs
+     * @param capacity smallest capacity to start from
+     * @return smallest power of 2 capacity which holds n pairs without passing the upper factor
+     */
+    size_t _capacityFor(size_t n, size_t capacity) const;
+
+    /**
+     *
+     * @param k
+     * @return full hash of key (using Hash), table picks the bucket
+     */
+    template<typename K>
+    size_t _getHash(const K& k) const
+    { return hasher{}(k); }
+
+    /**
+     * result of a single probe - key's full hash, its pair (nullptr if key is not in map)
+     * and the table holding it
+     */
+    struct probe
+    {
+        size_t hash;
+        pair* p;
+        table* t;
+    };
+
+    /**
+     * hashes key once and walks its bucket in place. every public lookup goes through here, and
+     * when the prefilter is on most misses stop at it without touching the table
+     * @param k
+     * @return probe result, reusable for emplace/erase without hashing again
+     */
+    template<typename K>
+    probe _find(const K& k) const
+    {
+        size_t hash = _getHash(k);
+        probe r{hash, nullptr, const_cast<table*>(&_map)};
+        if (_filter)
+        {
+            bool pass = _filter->mayContain(hash);
+            HASHMAP_STAT(_stats.filtered(!pass));
+            if (!pass)
+            {
+                HASHMAP_STAT(_stats.lookup(0));
+                return r;
+            }
+        }
+        r.p = _map.find(k, hash, key_equal{});
+        if (r.p == nullptr && _migrating())
+        {
+            r.p = _old.find(k, hash, key_equal{});
+            r.t = const_cast<table*>(&_old);
+        }
+#ifdef HASHMAP_STATS
+        if (r.p == nullptr && _filter)
+        {
+            _stats.falsePositive();
+        }
+        //walks the probe again, stats builds are for tuning, not for speed
+        size_t length = _map.probeLength(k, hash, key_equal{});
+        if (r.t == &_old)
+        {
+            length += _old.probeLength(k, hash, key_equal{});
+        }
+        _stats.lookup(length);
+#endif
+        return r;
+    }
+
+    /**
+     * single probe upsert core - finds key, and only if it is missing makes room and builds a
+     * pair from k and args in place
+     * @param k key, forwarded into the new pair
+     * @param args ValueT ctor args, untouched if key is already in map
+     * @return pointer to key's pair, and true if it was inserted
+     */
+    template<typename K, typename... Args>
+    std::pair<pair*, bool> _tryEmplace(K&& k, Args&& ... args);
+
+    /**
+     * single probe insert_or_assign core
+     * @param k key, forwarded into the new pair
+     * @param v value, assigned or forwarded into the new pair
+     * @return true if inserted, false if assigned
+     */
+    template<typename K, typename M>
+    bool _insertOrAssign(K&& k, M&& v);
+
+public:
+    /**
+     * default ctor
+     */
+    HashMap() : HashMap(Alloc())
+    {};
+
+    /**
+     * ctor with allocator of table storage
+     * @param alloc
+     */
+    explicit HashMap(const Alloc& alloc) : _size(SIZE_I), _low_factor(LOWER_I), _up_factor(UPPER_I), _alloc(alloc),
+                                           _map(CAP_I, alloc), _old(0, alloc), _migrated(0), _rehash_step(0)
+    {};
+
+    /**
+     * ctr1, gets upper & lower thresholds for hashmap size
+     * @param upper
+     * @param lower
+     * @param alloc
+     */
+    HashMap(double upper, double lower, const Alloc& alloc = Alloc());
+
+    /**
+     * ctor2, gets vectors of keys and values and keep them in map
+     * @param keys
+     * @param values
+     * @param alloc
+     */
+    HashMap(const std::vector<KeyT>& keys, const std::vector<ValueT>& values, const Alloc& alloc = Alloc());
+
+    /**
+     * copy ctor
+     * @param other
+     */
+    HashMap(const HashMap& other) :
+        _size(SIZE_I), _low_factor(other._low_factor), _up_factor(other._up_factor),
+        _alloc(std::allocator_traits<Alloc>::select_on_container_copy_construction(other._alloc)),
+        _map(other._map.capacity(), _alloc), _old(0, _alloc), _migrated(0), _rehash_step(other._rehash_step)
+    {
+        //perform deep copy, keys are unique and keep their stored hash
+        for (const table* t : {&other._old, &other._map})
+        {
+            for (cursor c = t->first(); c != t->last(); t->next(c))
+            {
+                _map.emplace(t->hash(c), t->get(c));
+            }
+        }
+        _size = other._size;
+        setPrefilter(other.hasPrefilter());
+    }
+
+    /**
+     * move ctor
+     * @param other
+     */
+    HashMap(HashMap && other) noexcept : _size(other._size), _low_factor(other._low_factor),
+                                        _up_factor(other._up_factor), _alloc(other._alloc),
+                                        _map(std::move(other._map)),
+                                        _old(std::move(other._old)), _migrated(other._migrated),
+                                        _rehash_step(other._rehash_step), _filter(std::move(other._filter))
+    { other._size = SIZE_I; }
+
+    /**
+     * dtor
+     */
+    ~HashMap() = default;
+
+    /**
+     *
+     * @return current size of map (num of values)
+     */
+    int size() const
+    { return _size; }
+
+    /**
+     *
+     * @return hashmap capacity
+     */
+    int capacity() const
+    { return _map.capacity(); }
+
+    /**
+     *
+     * @return current load factor
+     */
+    double getLoadFactor() const
+    { return ((double) size() / capacity()); }
+
+    /**
+     *
+     * @return true if map is empty, false otherwise
+     */
+    bool empty() const
+    { return size() == 0; }
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @param v value of type ValueT
+     * @return true upon successful insertion to map, false otherwise
+     */
+    bool insert(const KeyT& k, const ValueT& v)
+    { return _tryEmplace(k, v).second; }
+
+    /**
+     * inserts by moving key and value into map
+     * @param k key of type KeyT
+     * @param v value of type ValueT
+     * @return true upon successful insertion to map, false otherwise
+     */
+    bool insert(KeyT&& k, ValueT&& v)
+    { return _tryEmplace(std::move(k), std::move(v)).second; }
+
+    /**
+     * inserts a pair built in place from a key and value ctor args, unless the key is already in
+     * map. nothing is built then. a key the map cannot look up as is (not KeyT, and the hasher or
+     * comparator is not transparent) is converted to KeyT first
+     * @param k key, or any type KeyT is built from
+     * @param args ValueT ctor args
+     * @return true upon successful insertion to map, false otherwise
+     */
+    template<typename K, typename... Args,
+             typename = std::enable_if_t<!std::is_same<std::decay_t<K>, pair>::value>>
+    bool emplace(K&& k, Args&& ... args)
+    {
+        if constexpr (std::is_same<std::decay_t<K>, KeyT>::value ||
+                      (IsTransparent<hasher>::value && IsTransparent<key_equal>::value))
+        {
+            return _tryEmplace(std::forward<K>(k), std::forward<Args>(args)...).second;
+        }
+        else
+        {
+            return _tryEmplace(KeyT(std::forward<K>(k)), std::forward<Args>(args)...).second;
+        }
+    }
+
+    /**
+     * inserts a copy of a pair, unless its key is already in map
+     * @param p
+     * @return true upon successful insertion to map, false otherwise
+     */
+    bool emplace(const pair& p)
+    { return _tryEmplace(p.first, p.second).second; }
+
+    /**
+     * inserts a pair by moving it in, unless its key is already in map
+     * @param p
+     * @return true upon successful insertion to map, false otherwise
+     */
+    bool emplace(pair&& p)
+    { return _tryEmplace(std::move(p.first), std::move(p.second)).second; }
+
+    /**
+     * inserts a value built from args in place, if key is not in map. args are left untouched
+     * otherwise
+     * @param k key of type KeyT
+     * @param args ValueT ctor args
+     * @return true upon successful insertion to map, false otherwise
+     */
+    template<typename... Args>
+    bool try_emplace(const KeyT& k, Args&& ... args)
+    { return _tryEmplace(k, std::forward<Args>(args)...).second; }
+
+    /**
+     * try_emplace that moves the key in
+     * @param k key of type KeyT
+     * @param args ValueT ctor args
+     * @return true upon successful insertion to map, false otherwise
+     */
+    template<typename... Args>
+    bool try_emplace(KeyT&& k, Args&& ... args)
+    { return _tryEmplace(std::move(k), std::forward<Args>(args)...).second; }
+
+    /**
+     * inserts pair, or assigns v to the existing value of k
+     * @param k key of type KeyT
+     * @param v value assignable to ValueT
+     * @return true if inserted, false if assigned
+     */
+    template<typename M>
+    bool insert_or_assign(const KeyT& k, M&& v)
+    { return _insertOrAssign(k, std::forward<M>(v)); }
+
+    /**
+     * insert_or_assign that moves the key in
+     * @param k key of type KeyT
+     * @param v value assignable to ValueT
+     * @return true if inserted, false if assigned
+     */
+    template<typename M>
+    bool insert_or_assign(KeyT&& k, M&& v)
+    { return _insertOrAssign(std::move(k), std::forward<M>(v)); }
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return if key in map
+     */
+    bool containsKey(const KeyT& k) const
+    { return containsKey<KeyT>(k); }
+
+    /**
+     * heterogeneous lookup, e.g. std::string_view into a string keyed map
+     * @param k key comparable to KeyT
+     * @return if key in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    bool containsKey(const K& k) const;
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return value of given key, throws exception if key is not in map
+     */
+    ValueT& at(const KeyT& k) const
+    { return at<KeyT>(k); }
+
+    /**
+     * heterogeneous lookup, e.g. std::string_view into a string keyed map
+     * @param k key comparable to KeyT
+     * @return value of given key, throws exception if key is not in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    ValueT& at(const K& k) const;
+
+    /**
+     * lookup that neither throws nor inserts
+     * @param k key of type KeyT, or comparable to it
+     * @return pointer to value of given key, nullptr if key is not in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    ValueT* get(const K& k) const
+    {
+        pair* p = empty() ? nullptr : _find(k).p;
+        return p == nullptr ? nullptr : &p->second;
+    }
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return if value of give key was successfully removed
+     */
+    bool erase(const KeyT& k)
+    { return erase<KeyT>(k); }
+
+    /**
+     * heterogeneous erase, e.g. std::string_view from a string keyed map
+     * @param k key comparable to KeyT
+     * @return if value of give key was successfully removed
+     */
+    template<typename K, typename = LookupKey<K>>
+    bool erase(const K& k);
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return size of bucket
+     */
+    int bucketSize(const KeyT& k) const;
+
+    /**
+     * removes all elements in map
+     */
+    void clear();
+
+    /**
+     * grows table once so that n pairs fit without resizing. never shrinks
+     * @param n num of pairs
+     */
+    void reserve(size_t n);
+
+    /**
+     * moves pairs to a table of at least given num of buckets (rounded up to a power of 2, and up
+     * to what the current pairs need)
+     * @param buckets
+     */
+    void rehash(size_t buckets);
+
+    /**
+     * turns incremental rehash on or off. when on, a resize keeps the old table next to the new
+     * one and every insert/erase moves at most bucketsPerOp buckets, so no single call pays for
+     * the whole map. lookups check both tables meanwhile
+     * @param bucketsPerOp buckets moved per mutating operation, 0 to resize all at once (default)
+     */
+    void setIncrementalRehash(size_t bucketsPerOp)
+    {
+        _rehash_step = bucketsPerOp;
+        if (_rehash_step == 0)
+        {
+            _migrate(_old.capacity());
+        }
+    }
+
+    /**
+     *
+     * @return true if an incremental rehash is in progress
+     */
+    bool isRehashing() const
+    { return _migrating(); }
+
+    /**
+     * attaches a bloom filter in front of lookups, so most lookups of missing keys are answered
+     * without probing the table. the filter is kept up on insert and rebuilt on every rehash,
+     * erased keys stay in it until then
+     * @param on true to attach a filter, false to drop it
+     */
+    void setPrefilter(bool on);
+
+    /**
+     *
+     * @return true if lookups go through a prefilter
+     */
+    bool hasPrefilter() const
+    { return _filter != nullptr; }
+
+#ifdef HASHMAP_STATS
+    /**
+     * telemetry, only in builds with HASHMAP_STATS defined
+     * @return counters since construction, and current size, capacity and bytes of storage
+     */
+    HashMapReport stats() const;
+#endif
+
+    /**
+     * copy operator=
+     * @param other
+     * @return reference to hashmap
+     */
+    HashMap& operator=(const HashMap& other)
+    {
+        if (this != &other)
+        {
+            HashMap copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * move operator=
+     * @param other
+     * @return
+     */
+    HashMap& operator=(HashMap && other) noexcept
+    {
+        std::swap(_size, other._size);
+        std::swap(_low_factor, other._low_factor);
+        std::swap(_up_factor, other._up_factor);
+        std::swap(_alloc, other._alloc);
+        _map.swap(other._map);
+        _old.swap(other._old);
+        std::swap(_migrated, other._migrated);
+        std::swap(_rehash_step, other._rehash_step);
+        _filter.swap(other._filter);
+        HASHMAP_STAT(std::swap(_stats, other._stats));
+        return *this;
+    }
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return value of given key in map
+     */
+    const ValueT& operator[](const KeyT& k) const noexcept
+    { return operator[]<KeyT>(k); }
+
+    /**
+     * heterogeneous read, e.g. std::string_view into a string keyed map
+     * @param k key comparable to KeyT
+     * @return value of given key in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    const ValueT& operator[](const K& k) const noexcept;
+
+    /**
+     *
+     * @param k key of type KeyT
+     * @return assigning value of given key in map
+     */
+    ValueT& operator[](const KeyT& k)
+    { return _tryEmplace(k).first->second; }
+
+    /**
+     * operator [] that moves the key in if it is inserted
+     * @param k key of type KeyT
+     * @return assigning value of given key in map
+     */
+    ValueT& operator[](KeyT&& k)
+    { return _tryEmplace(std::move(k)).first->second; }
+
+    /**
+     * heterogeneous write, e.g. std::string_view into a string keyed map. KeyT is built from k
+     * only if k is not in map yet
+     * @param k key comparable to KeyT
+     * @return assigning value of given key in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    ValueT& operator[](const K& k);
+
+    /**
+     *
+     * @param other
+     * @return true if maps are the same, false otherwise
+     */
+    bool operator==(const HashMap& other) const;
+
+    /**
+     *
+     * @param other
+     * @return true if maps are different, false otherwise
+     */
+    bool operator!=(const HashMap& other) const
+    { return !(*this == other); }
+
+    // ************** const_iterator ************** //
+    /**
+     * HashMap iterator, walks the table's pairs through a layout specific cursor. while a rehash is
+     * in progress it walks the old table first, then the new one
+     */
+    class const_iterator
+    {
+    private:
+        const table* _table;
+        const table* _next;
+        cursor _cur;
+    public:
+        /**
+         * default ctor
+         * @param t table to walk
+         * @param next table to walk once t is done, nullptr if none
+         * @param c position in t
+         */
+        explicit const_iterator(const table* t, const table* next, cursor c) : _table(t), _next(next), _cur(c)
+        {
+            if (_next != nullptr && _cur == _table->last())
+            {
+                _table = _next, _next = nullptr, _cur = _table->first();
+            }
+        };
+
+        /**
+         * dereference operator for reading
+         * @return value of obj
+         */
+        const std::pair<KeyT, ValueT>& operator*() const
+        { return _table->get(_cur); }
+
+        /**
+         * member access for reading
+         * @return pointer to obj
+         */
+        const std::pair<KeyT, ValueT>* operator->() const
+        { return &_table->get(_cur); }
+
+        /**
+         * pre-increment
+         * @return
+         */
+        const_iterator& operator++()
+        {
+            _table->next(_cur);
+            if (_next != nullptr && _cur == _table->last())
+            {
+                _table = _next, _next = nullptr, _cur = _table->first();
+            }
+            return *this;
+        }
+
+        /**
+         * post-increment
+         * @return
+         */
+        const_iterator operator++(int)
+        {
+            auto result = *this;
+            ++(*this);
+            return result;
+        }
+
+        /**
+         *
+         * @param other
+         * @return true if 2 iterators point to same obj, false otherwise
+         */
+        bool operator==(const const_iterator& other) const
+        { return _table == other._table && _cur == other._cur; }
+
+        /**
+         *
+         * @param other
+         * @return true if 2 iterators point to different obj, false otherwise
+         */
+        bool operator!=(const const_iterator& other) const
+        { return !(*this == other); }
+    };
+
+    /**
+    *
+    * @return iterator to first pair in map
+    */
+    const_iterator begin() const
+    {
+        if (_migrating())
+        {
+            return const_iterator(&_old, &_map, _old.first());
+        }
+        return const_iterator(&_map, nullptr, _map.first());
+    }
+
+    /**
+     *
+     * @return iterator that indicates end of objects in map
+     */
+    const_iterator end() const
+    { return const_iterator(&_map, nullptr, _map.last()); }
+
+    /**
+     *
+     * @return iterator to first pair in map
+     */
+    const_iterator cbegin() const
+    { return begin(); }
+
+    /**
+     *
+     * @return iterator that indicates end of objects in map
+     */
+    const_iterator cend() const
+    { return end(); }
+};
+
+/**
+ * ctor with upper and lower load factors
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param upper
+ * @param lower
+ * @param alloc
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::HashMap(double upper, double lower, const Alloc& alloc) :
+    HashMap(alloc)
+{
+    if (upper < 0 || upper > 1 || lower < 0 || lower > 1 || upper < lower)
+    {
+        std::cerr << "exiting ctor due to illegal params\n";
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+    _low_factor = lower, _up_factor = upper;
+}
+
+/**
+ * finds key, and inserts a new pair only if it is missing
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @param args
+ * @return pointer to key's pair, and true upon insertion
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename... Args>
+std::pair<typename HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::pair*, bool>
+HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_tryEmplace(K&& k, Args&& ... args)
+{
+    probe r = _find(k);
+    if (r.p != nullptr)
+    {
+        return {r.p, false};
+    }
+    ++_size; _resize(UPSIZE);
+    pair* p = _map.emplace(r.hash, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(k)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    if (_filter)
+    {
+        _filter->add(r.hash);
+    }
+    HASHMAP_STAT(_stats.insert());
+    return {p, true};
+}
+
+/**
+ * assigns value of key, or inserts a new pair if key is missing
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @param v
+ * @return true upon insertion
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename M>
+bool HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_insertOrAssign(K&& k, M&& v)
+{
+    probe r = _find(k);
+    if (r.p != nullptr)
+    {
+        r.p->second = std::forward<M>(v);
+        return false;
+    }
+    ++_size; _resize(UPSIZE);
+    _map.emplace(r.hash, std::forward<K>(k), std::forward<M>(v));
+    if (_filter)
+    {
+        _filter->add(r.hash);
+    }
+    HASHMAP_STAT(_stats.insert());
+    return true;
+}
+
+/**
+ * erase a pair by key
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @return true upon success
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename>
+bool HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::erase(const K& k)
+{
+    probe r = _find(k);
+    if (r.p == nullptr)
+    {
+        return false;
+    }
+    r.t->erase(r.p, r.hash);
+    HASHMAP_STAT(_stats.erase());
+    --_size; _resize(DOWNSIZE);
+    return true;
+}
+
+/**
+ * resizing map
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param sign indicates if upsize/downsize
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_resize(int sign)
+{
+    if (sign == UPSIZE && getLoadFactor() > _up_factor)
+    {
+        //a moved-from map has no table left
+        _rehash(_map.capacity() == 0 ? CAP_I : _map.capacity() * FACTOR);
+    }
+    else if (sign == DOWNSIZE && getLoadFactor() < _low_factor && _map.capacity() > 1)
+    {
+        _rehash(_map.capacity() / FACTOR);
+    }
+    else if (sign == UPSIZE && (double) (_size + _map.tombstones()) / capacity() > _up_factor)
+    {
+        //same capacity, but drop the tombstones left by erase
+        _rehash(_map.capacity());
+    }
+    else if (_migrating())
+    {
+        HASHMAP_STAT(auto start = HashMapStats::now());
+        _migrate(_rehash_step);
+        HASHMAP_STAT(_stats.timed(start));
+    }
+}
+
+/**
+ * starts moving all pairs to a new table
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param capacity of new table
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_rehash(size_t capacity)
+{
+    HASHMAP_STAT(auto start = HashMapStats::now());
+    HASHMAP_STAT(size_t from = _map.capacity());
+    //a rehash that is still running has to land before the next one starts
+    _migrate(_old.capacity());
+
+    table next(capacity, _alloc);
+    _old = std::move(_map);
+    _map = std::move(next);
+    _migrated = 0;
+    _migrate(_rehash_step == 0 ? _old.capacity() : _rehash_step);
+    if (_filter)
+    {
+        _rebuildFilter(capacity);
+    }
+    HASHMAP_STAT(_stats.resized(from, capacity, start));
+}
+
+#ifdef HASHMAP_STATS
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+HashMapReport HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::stats() const
+{
+    HashMapReport report;
+    report.size = _size;
+    report.capacity = _map.capacity();
+    report.bytes = sizeof(*this) + _map.bytes() + _old.bytes() + (_filter ? _filter->bytes() : 0);
+    report.loadFactor = getLoadFactor();
+    report.filtered = _filter != nullptr;
+    _stats.fill(report);
+    return report;
+}
+#endif
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+size_t HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_capacityFor(size_t n, size_t capacity) const
+{
+    //an upper factor of 0 grows on every insert, size for a full table then
+    double factor = _up_factor > 0 ? _up_factor : 1;
+    while ((double) n / capacity > factor)
+    {
+        capacity *= FACTOR;
+    }
+    return capacity;
+}
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::reserve(size_t n)
+{
+    size_t capacity = _capacityFor(n, _map.capacity() == 0 ? CAP_I : _map.capacity());
+    if (capacity != _map.capacity())
+    {
+        _rehash(capacity);
+    }
+}
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::rehash(size_t buckets)
+{
+    size_t capacity = 1;
+    while (capacity < buckets)
+    {
+        capacity *= FACTOR;
+    }
+    capacity = _capacityFor(_size, capacity);
+    if (capacity != _map.capacity())
+    {
+        _rehash(capacity);
+    }
+}
+
+/**
+ * refills the prefilter
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param capacity of current table
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_rebuildFilter(size_t capacity)
+{
+    _filter->reset(std::max<size_t>(capacity * _up_factor, _size));
+    for (const table* t : {&_old, &_map})
+    {
+        for (cursor c = t->first(); c != t->last(); t->next(c))
+        {
+            _filter->add(t->hash(c));
+        }
+    }
+}
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::setPrefilter(bool on)
+{
+    if (!on)
+    {
+        _filter.reset();
+    }
+    else if (!_filter)
+    {
+        _filter.reset(new BloomFilter(0));
+        _rebuildFilter(_map.capacity());
+    }
+}
+
+/**
+ * moves buckets of the old table into the current one
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param buckets max num of buckets to move
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::_migrate(size_t buckets)
+{
+    if (!_migrating())
+    {
+        return;
+    }
+    _old.drain(_migrated, buckets, [this](pair && p, size_t hash)
+    {
+        _map.emplace(hash, std::move(p));
+    });
+    if (_migrated == _old.capacity())
+    {
+        _old = table(0, _alloc);
+        _migrated = 0;
+    }
+}
+
+/**
+ *
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @return true if key in map, false otherwise
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename>
+bool HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::containsKey(const K& k) const
+{
+    if (empty())
+    {
+        return false;
+    }
+    return _find(k).p != nullptr;
+}
+
+/**
+ * ctor with given keys anf values, table is sized once for all of them and the pairs are placed in
+ * bulk
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param keys
+ * @param values
+ * @param alloc
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::HashMap(const std::vector<KeyT>& keys,
+                                                              const std::vector<ValueT>& values, const Alloc& alloc) :
+    HashMap(alloc)
+{
+    try
+    {
+        if (keys.size() != values.size())
+        {
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+        //final capacity up front, so the load never passes through the intermediate sizes
+        reserve(keys.size());
+
+        //all hashes first, so the slot of a pair a few ahead can be prefetched while this one is
+        //placed. the table is fresh and big enough, so pairs go straight into it, with no resize
+        //checks, and a find only ever hits a duplicate key, whose later value wins
+        std::vector<size_t> hashes(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            hashes[i] = _getHash(keys[i]);
+        }
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i + BULK_AHEAD < keys.size())
+            {
+                _map.prefetch(hashes[i + BULK_AHEAD]);
+            }
+            pair* p = _map.find(keys[i], hashes[i], key_equal{});
+            if (p != nullptr)
+            {
+                p->second = values[i];
+                continue;
+            }
+            _map.emplace(hashes[i], keys[i], values[i]);
+            ++_size;
+            HASHMAP_STAT(_stats.insert());
+        }
+    }
+    catch (std::invalid_argument& e)
+    {
+        std::cerr << "exiting ctor due to illegal params\n";
+        throw;
+    }
+}
+
+/**
+ *
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @return size of given key's bucket
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+int HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::bucketSize(const KeyT& k) const
+{
+    probe r = _find(k);
+    if (r.p == nullptr)
+    {
+        std::cerr << "exiting bucketsize() due to exception\n";
+        throw std::out_of_range("exiting bucketsize() due to exception\n");
+    }
+    return r.t->bucketSize(r.hash);
+}
+
+/**
+ * operator [] for reading
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @return
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename>
+const ValueT& HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::operator[](const K& k) const noexcept
+{
+    static const ValueT undefined{};
+    pair* p = _find(k).p;
+    if (p == nullptr) return undefined; //undefined
+    return p->second;
+}
+
+/**
+ * operator [] for writing
+ * @tparam KeyT
+ * @tparam ValueT
+ * @param k
+ * @return
+ */
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename>
+ValueT& HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::operator[](const K& k)
+{
+    return _tryEmplace(k).first->second;
+}
+
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+void HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::clear()
+{
+    _map.clear();
+    _old = table(0, _alloc);
+    _migrated = 0;
+    _size = 0;
+    if (_filter)
+    {
+        _filter->clear();
+    }
+}
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+template<typename K, typename>
+ValueT& HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::at(const K& k) const
+{
+    pair* p = _find(k).p;
+    if (p != nullptr)
+    {
+        return p->second;
+    }
+    std::cerr << "exiting at() due to exception\n";
+    throw std::out_of_range("exiting at() due to exception\n");
+}
+
+template<typename KeyT, typename ValueT, typename Layout, typename Hash, typename KeyEqual, typename Alloc>
+bool HashMap<KeyT, ValueT, Layout, Hash, KeyEqual, Alloc>::operator==(const HashMap& other) const
+{
+    if (size() != other.size() || capacity() != other.capacity() ||
+        _low_factor != other._low_factor || _up_factor != other._up_factor)
+    {
+        return false;
+    }
+
+    for (auto it = cbegin(); it != cend(); ++it)
+    {
+        pair* p = other._find((*it).first).p;
+        if (p == nullptr || (*it).second != p->second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif //EX3_HASHMAP_HPP
@@ -0,0 +1,210 @@
+#ifndef EX3_HASHMAPSTATS_HPP
+#define EX3_HASHMAPSTATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+#define STATS_PROBE_BINS 16
+
+/**
+ * statements kept only in builds with HASHMAP_STATS defined, so the counters cost nothing otherwise
+ */
+#ifdef HASHMAP_STATS
+#define HASHMAP_STAT(statement) statement
+#else
+#define HASHMAP_STAT(statement)
+#endif
+
+/**
+ * telemetry of a HashMap at one point in time
+ */
+struct HashMapReport
+{
+    size_t size, capacity, bytes;
+    double loadFactor;
+    size_t lookups; //probes of the table, insert and erase probe too
+    size_t inserts, erases;
+    size_t grows, shrinks, rehashes; //rehashes keep the capacity (tombstone cleanup, rehash())
+    double resizeSeconds; //in resizes, and in incremental migration steps
+    size_t probes[STATS_PROBE_BINS]; //lookups by probe length, last bin counts all longer ones
+    bool filtered; //a prefilter is on
+    size_t filterQueries; //lookups that consulted the prefilter
+    size_t filterRejected; //answered by the prefilter alone
+    size_t filterFalsePositives; //passed the prefilter, but key was not there
+
+    /**
+     * writes report as a json object
+     * @param os
+     */
+    void toJson(std::ostream& os) const
+    {
+        os << "{\"size\": " << size << ", \"capacity\": " << capacity << ", \"bytes\": " << bytes
+           << ", \"load_factor\": " << loadFactor << ", \"lookups\": " << lookups << ", \"inserts\": " << inserts
+           << ", \"erases\": " << erases << ", \"grows\": " << grows << ", \"shrinks\": " << shrinks
+           << ", \"rehashes\": " << rehashes << ", \"resize_seconds\": " << resizeSeconds << ", \"probe_lengths\": [";
+        for (int i = 0; i < STATS_PROBE_BINS; ++i)
+        {
+            os << (i == 0 ? "" : ", ") << probes[i];
+        }
+        os << "], \"prefilter\": ";
+        if (filtered)
+        {
+            os << "{\"queries\": " << filterQueries << ", \"rejected\": " << filterRejected
+               << ", \"false_positives\": " << filterFalsePositives << "}";
+        }
+        else
+        {
+            os << "null";
+        }
+        os << "}";
+    }
+};
+
+/**
+ * counters of a HashMap. they are relaxed atomics, so concurrent const readers may count too.
+ * copies start from the counts of the source
+ */
+class HashMapStats
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::atomic<size_t> _lookups, _inserts, _erases, _grows, _shrinks, _rehashes, _resizeNanos;
+    std::atomic<size_t> _probes[STATS_PROBE_BINS];
+    std::atomic<size_t> _filterQueries, _filterRejected, _filterFalsePositives;
+
+    /**
+     *
+     * @param counter
+     */
+    static void _bump(std::atomic<size_t>& counter, size_t n = 1)
+    { counter.fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     *
+     * @param counter
+     * @return its value
+     */
+    static size_t _get(const std::atomic<size_t>& counter)
+    { return counter.load(std::memory_order_relaxed); }
+
+public:
+    using time_point = clock::time_point;
+
+    /**
+     * ctor, all counters 0
+     */
+    HashMapStats() : _lookups(0), _inserts(0), _erases(0), _grows(0), _shrinks(0), _rehashes(0), _resizeNanos(0),
+                     _probes(), _filterQueries(0), _filterRejected(0), _filterFalsePositives(0)
+    {}
+
+    /**
+     * copy ctor
+     * @param other
+     */
+    HashMapStats(const HashMapStats& other) : HashMapStats()
+    { *this = other; }
+
+    /**
+     * copy operator=
+     * @param other
+     * @return
+     */
+    HashMapStats& operator=(const HashMapStats& other)
+    {
+        _lookups = _get(other._lookups), _inserts = _get(other._inserts), _erases = _get(other._erases);
+        _grows = _get(other._grows), _shrinks = _get(other._shrinks), _rehashes = _get(other._rehashes);
+        _resizeNanos = _get(other._resizeNanos);
+        for (int i = 0; i < STATS_PROBE_BINS; ++i)
+        {
+            _probes[i] = _get(other._probes[i]);
+        }
+        _filterQueries = _get(other._filterQueries), _filterRejected = _get(other._filterRejected);
+        _filterFalsePositives = _get(other._filterFalsePositives);
+        return *this;
+    }
+
+    /**
+     *
+     * @return start of a timed section
+     */
+    static time_point now()
+    { return clock::now(); }
+
+    /**
+     * counts a probe of the table
+     * @param length slots (flat) or entries (chained) probed
+     */
+    void lookup(size_t length)
+    {
+        _bump(_lookups);
+        _bump(_probes[length < STATS_PROBE_BINS ? length : STATS_PROBE_BINS - 1]);
+    }
+
+    /**
+     * counts a lookup that consulted the prefilter
+     * @param rejected true if the prefilter answered it alone
+     */
+    void filtered(bool rejected)
+    {
+        _bump(_filterQueries);
+        if (rejected)
+        {
+            _bump(_filterRejected);
+        }
+    }
+
+    /**
+     * counts a lookup that passed the prefilter, but did not find its key
+     */
+    void falsePositive()
+    { _bump(_filterFalsePositives); }
+
+    void insert()
+    { _bump(_inserts); }
+
+    void erase()
+    { _bump(_erases); }
+
+    /**
+     * counts a move of all pairs to a new table, and its time
+     * @param from old capacity
+     * @param to new capacity
+     * @param start
+     */
+    void resized(size_t from, size_t to, time_point start)
+    {
+        _bump(to > from ? _grows : to < from ? _shrinks : _rehashes);
+        timed(start);
+    }
+
+    /**
+     * adds time since start to resize time
+     * @param start
+     */
+    void timed(time_point start)
+    {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        _bump(_resizeNanos, nanos);
+    }
+
+    /**
+     * fills the counter fields of a report
+     * @param report
+     */
+    void fill(HashMapReport& report) const
+    {
+        report.lookups = _get(_lookups), report.inserts = _get(_inserts), report.erases = _get(_erases);
+        report.grows = _get(_grows), report.shrinks = _get(_shrinks), report.rehashes = _get(_rehashes);
+        report.resizeSeconds = _get(_resizeNanos) / 1e9;
+        for (int i = 0; i < STATS_PROBE_BINS; ++i)
+        {
+            report.probes[i] = _get(_probes[i]);
+        }
+        report.filterQueries = _get(_filterQueries), report.filterRejected = _get(_filterRejected);
+        report.filterFalsePositives = _get(_filterFalsePositives);
+    }
+};
+
+#endif //EX3_HASHMAPSTATS_HPP
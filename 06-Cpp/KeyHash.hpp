@@ -0,0 +1,58 @@
+#ifndef EX3_KEYHASH_HPP
+#define EX3_KEYHASH_HPP
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+#include "StringHash.hpp"
+
+/**
+ * default hasher of HashMap keys, std::hash of the key
+ * @tparam KeyT
+ */
+template<typename KeyT, typename = void>
+struct KeyHash
+{
+    size_t operator()(const KeyT& k) const
+    { return std::hash<KeyT>{}(k); }
+};
+
+/**
+ * integral and enum keys - std::hash is the identity for them, which leaves the high bits zero
+ * for small keys, and the flat and dense layouts take their tag from the high bits. the key is
+ * mixed instead
+ * @tparam KeyT
+ */
+template<typename KeyT>
+struct KeyHash<KeyT, std::enable_if_t<std::is_integral_v<KeyT> || std::is_enum_v<KeyT>>>
+{
+    size_t operator()(KeyT k) const
+    { return StringHash::hashWord(static_cast<uint64_t>(k)); }
+};
+
+/**
+ * string keys hash through std::string_view with StringHash, so std::string, std::string_view
+ * and const char* give the same hash and can all be used for lookup without building a temporary
+ * string
+ */
+template<>
+struct KeyHash<std::string> : StringHash
+{
+};
+
+/**
+ * true if a hasher or key comparator accepts other types than the key (declares is_transparent)
+ * @tparam Hash
+ */
+template<typename Hash, typename = void>
+struct IsTransparent : std::false_type
+{
+};
+
+template<typename Hash>
+struct IsTransparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type
+{
+};
+
+#endif //EX3_KEYHASH_HPP
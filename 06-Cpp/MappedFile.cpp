@@ -0,0 +1,48 @@
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MappedFile.h"
+
+/**
+ * ctor, maps the whole file read only
+ * @param path
+ */
+MappedFile::MappedFile(const std::string& path) : _data(nullptr), _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    _size = st.st_size;
+    if (_size > 0)
+    {
+        void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw std::invalid_argument("exiting ctor due to illegal params\n");
+        }
+        _data = static_cast<const char*>(p);
+    }
+    //the mapping keeps the file alive
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+    {
+        munmap((void*) _data, _size);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef EX3_MAPPEDFILE_H
+#define EX3_MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * read only memory mapping of a whole file, unmapped on destruction
+ */
+class MappedFile
+{
+private:
+    const char* _data;
+    size_t _size;
+
+public:
+    /**
+     * ctor, maps the file. throws exception if it cannot be opened or mapped
+     * @param path
+     */
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile& other) = delete;
+
+    /**
+     * move ctor
+     * @param other
+     */
+    MappedFile(MappedFile && other) noexcept : _data(other._data), _size(other._size)
+    {
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    /**
+     * dtor, unmaps
+     */
+    ~MappedFile();
+
+    /**
+     *
+     * @return first byte of file (nullptr for an empty file)
+     */
+    const char* data() const
+    { return _data; }
+
+    /**
+     *
+     * @return file size in bytes
+     */
+    size_t size() const
+    { return _size; }
+};
+
+#endif //EX3_MAPPEDFILE_H
@@ -0,0 +1,220 @@
+#ifndef EX3_RCUCELL_HPP
+#define EX3_RCUCELL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include "CacheLine.hpp"
+
+#define READERS_I 64
+#define EPOCH_IDLE std::numeric_limits<uint64_t>::max()
+
+/**
+ * read-copy-update cell. holds the current version of an immutable T behind an atomic pointer.
+ * writers publish a whole new version, old versions are freed with epoch based reclamation.
+ * a reader announces the global epoch in its own slot before loading the pointer, so reading
+ * takes plain loads and stores only - no locks and no read-modify-write. a retired version is
+ * freed once every busy reader has announced an epoch past its retirement.
+ * @tparam T
+ */
+template<typename T>
+class RcuCell
+{
+private:
+    /**
+     * a reader's announced epoch, on its own cache line
+     */
+    struct alignas(CACHE_LINE) slot
+    {
+        std::atomic<uint64_t> epoch{EPOCH_IDLE};
+        std::atomic<bool> taken{false};
+    };
+
+    std::atomic<const T*> _current;
+    std::atomic<uint64_t> _epoch;
+    size_t _slotCount;
+    std::unique_ptr<slot[]> _slots;
+    std::mutex _writer;
+    std::vector<std::pair<uint64_t, const T*>> _retired; //guarded by _writer
+
+    /**
+     * frees every retired version no busy reader can still see. called with _writer held
+     * @return num of freed versions
+     */
+    size_t _reclaim();
+
+public:
+    /**
+     * per thread read handle. owns one reader slot of the cell until destroyed
+     */
+    class Reader
+    {
+    private:
+        RcuCell* _cell;
+        slot* _slot;
+
+        /**
+         * marks slot idle when a read ends, also on exception
+         */
+        struct unpin
+        {
+            slot* s;
+
+            ~unpin()
+            { s->epoch.store(EPOCH_IDLE, std::memory_order_release); }
+        };
+
+    public:
+        /**
+         * ctor
+         * @param cell
+         * @param s claimed slot
+         */
+        Reader(RcuCell* cell, slot* s) : _cell(cell), _slot(s)
+        {};
+
+        Reader(const Reader& other) = delete;
+
+        /**
+         * move ctor
+         * @param other
+         */
+        Reader(Reader && other) noexcept : _cell(other._cell), _slot(other._slot)
+        { other._slot = nullptr; }
+
+        Reader& operator=(const Reader& other) = delete;
+
+        /**
+         * dtor, gives slot back
+         */
+        ~Reader()
+        {
+            if (_slot != nullptr)
+            {
+                _slot->taken.store(false, std::memory_order_release);
+            }
+        }
+
+        /**
+         * calls f on the current version. the version stays alive until f returns. reads through
+         * the same Reader must not nest
+         * @param f callable with const T&
+         * @return what f returns
+         */
+        template<typename F>
+        auto read(F&& f) const
+        {
+            _slot->epoch.store(_cell->_epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+            unpin guard{_slot};
+            return f(*_cell->_current.load(std::memory_order_seq_cst));
+        }
+    };
+
+    /**
+     * ctor
+     * @param initial first version
+     * @param readers max num of concurrent Reader handles
+     */
+    explicit RcuCell(std::unique_ptr<T> initial, size_t readers = READERS_I) :
+        _current(initial.release()), _epoch(0), _slotCount(readers), _slots(new slot[readers])
+    {};
+
+    RcuCell(const RcuCell& other) = delete;
+
+    RcuCell& operator=(const RcuCell& other) = delete;
+
+    /**
+     * dtor, no reader may be left
+     */
+    ~RcuCell()
+    {
+        delete _current.load();
+        for (auto& r : _retired)
+        {
+            delete r.second;
+        }
+    }
+
+    /**
+     * claims a reader slot. this is the only step of reading with an atomic read-modify-write,
+     * so a thread should keep its Reader
+     * @return read handle, throws exception if all slots are taken
+     */
+    Reader reader()
+    {
+        for (size_t i = 0; i < _slotCount; ++i)
+        {
+            bool expected = false;
+            if (_slots[i].taken.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return Reader(this, &_slots[i]);
+            }
+        }
+        throw std::length_error("exiting reader() due to exception\n");
+    }
+
+    /**
+     * makes next the current version. readers still in the old one keep it until they are done
+     * @param next
+     */
+    void publish(std::unique_ptr<T> next)
+    {
+        std::lock_guard<std::mutex> guard(_writer);
+        const T* old = _current.exchange(next.release(), std::memory_order_seq_cst);
+        uint64_t epoch = _epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        _retired.emplace_back(epoch, old);
+        _reclaim();
+    }
+
+    /**
+     * frees retired versions no reader can see anymore
+     * @return num of freed versions
+     */
+    size_t reclaim()
+    {
+        std::lock_guard<std::mutex> guard(_writer);
+        return _reclaim();
+    }
+
+    /**
+     * current version for writers - only safe while no other thread publishes
+     * @return
+     */
+    const T& latest() const
+    { return *_current.load(std::memory_order_acquire); }
+};
+
+template<typename T>
+size_t RcuCell<T>::_reclaim()
+{
+    uint64_t oldest = EPOCH_IDLE;
+    for (size_t i = 0; i < _slotCount; ++i)
+    {
+        oldest = std::min(oldest, _slots[i].epoch.load(std::memory_order_seq_cst));
+    }
+
+    //a version retired at epoch e is only seen by readers that announced an epoch below e
+    size_t freed = 0;
+    for (size_t i = 0; i < _retired.size();)
+    {
+        if (_retired[i].first <= oldest)
+        {
+            delete _retired[i].second;
+            _retired[i] = _retired.back();
+            _retired.pop_back();
+            ++freed;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return freed;
+}
+
+#endif //EX3_RCUCELL_HPP
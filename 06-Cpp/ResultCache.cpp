@@ -0,0 +1,114 @@
+#include <algorithm>
+#include "ResultCache.h"
+#include "StringHash.hpp"
+
+#define DIGEST_SEED_LO 0x243F6A8885A308D3ULL
+#define DIGEST_SEED_HI 0x13198A2E03707344ULL
+
+ResultCache::ResultCache(size_t bytes) : _shards(new Shard[CACHE_SHARDS]),
+                                         _perShard(std::max<size_t>(1, bytes / entryBytes() / CACHE_SHARDS))
+{
+    for (size_t i = 0; i < CACHE_SHARDS; ++i)
+    {
+        Shard& s = _shards[i];
+        s.index.reserve(_perShard);
+        s.nodes.reserve(_perShard);
+        s.head = s.tail = CACHE_NONE;
+        s.hits = s.misses = s.evictions = 0;
+    }
+}
+
+Digest ResultCache::digest(const char* data, size_t len)
+{ return Digest{StringHash::hash(data, len, DIGEST_SEED_LO), StringHash::hash(data, len, DIGEST_SEED_HI)}; }
+
+size_t ResultCache::entryBytes()
+{
+    //a flat index slot is the pair, its stored hash and a control byte, and the table is kept
+    //between a quarter and three quarters full
+    return sizeof(Node) + 2 * (sizeof(std::pair<Digest, uint32_t>) + sizeof(size_t) + 1);
+}
+
+void ResultCache::_unlink(Shard& s, uint32_t i)
+{
+    Node& n = s.nodes[i];
+    (n.prev == CACHE_NONE ? s.head : s.nodes[n.prev].next) = n.next;
+    (n.next == CACHE_NONE ? s.tail : s.nodes[n.next].prev) = n.prev;
+}
+
+void ResultCache::_pushFront(Shard& s, uint32_t i)
+{
+    Node& n = s.nodes[i];
+    n.prev = CACHE_NONE;
+    n.next = s.head;
+    (s.head == CACHE_NONE ? s.tail : s.nodes[s.head].prev) = i;
+    s.head = i;
+}
+
+bool ResultCache::get(const Digest& d, uint64_t version, int threshold, Result& result)
+{
+    Shard& s = _shardOf(d);
+    std::lock_guard<std::mutex> guard(s.lock);
+    const uint32_t* i = s.index.get(d);
+    if (i == nullptr || s.nodes[*i].version != version || s.nodes[*i].threshold != threshold)
+    {
+        ++s.misses;
+        return false;
+    }
+    ++s.hits;
+    result = s.nodes[*i].result;
+    _unlink(s, *i);
+    _pushFront(s, *i);
+    return true;
+}
+
+void ResultCache::put(const Digest& d, uint64_t version, int threshold, const Result& result)
+{
+    Shard& s = _shardOf(d);
+    std::lock_guard<std::mutex> guard(s.lock);
+    uint32_t* found = s.index.get(d);
+    uint32_t i;
+    if (found != nullptr)
+    {
+        //stale version or threshold, or a racing scorer of the same message
+        i = *found;
+        _unlink(s, i);
+    }
+    else if (s.nodes.size() < _perShard)
+    {
+        i = (uint32_t) s.nodes.size();
+        s.nodes.push_back(Node{});
+        s.index.try_emplace(d, i);
+    }
+    else
+    {
+        i = s.tail;
+        _unlink(s, i);
+        s.index.erase(s.nodes[i].key);
+        s.index.try_emplace(d, i);
+        ++s.evictions;
+    }
+    Node& n = s.nodes[i];
+    n.key = d;
+    n.version = version;
+    n.threshold = threshold;
+    n.result = result;
+    _pushFront(s, i);
+}
+
+void ResultCache::toJson(std::ostream& os) const
+{
+    size_t hits = 0, misses = 0, evictions = 0, entries = 0;
+    for (size_t i = 0; i < CACHE_SHARDS; ++i)
+    {
+        Shard& s = _shards[i];
+        std::lock_guard<std::mutex> guard(s.lock);
+        hits += s.hits;
+        misses += s.misses;
+        evictions += s.evictions;
+        entries += s.nodes.size();
+    }
+    size_t lookups = hits + misses;
+    os << "{\"hits\": " << hits << ", \"misses\": " << misses << ", \"hit_rate\": "
+       << (lookups == 0 ? 0 : (double) hits / lookups) << ", \"evictions\": " << evictions << ", \"entries\": "
+       << entries << ", \"capacity\": " << capacity() << ", \"bytes\": " << entries * entryBytes() << "}";
+}
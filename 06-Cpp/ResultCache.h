@@ -0,0 +1,162 @@
+#ifndef EX3_RESULTCACHE_H
+#define EX3_RESULTCACHE_H
+
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include "HashMap.hpp"
+
+#define CACHE_SHARDS 16
+#define CACHE_NONE UINT32_MAX
+
+/**
+ * 128 bit digest of a message
+ */
+struct Digest
+{
+    uint64_t lo, hi;
+
+    bool operator==(const Digest& other) const
+    { return lo == other.lo && hi == other.hi; }
+};
+
+/**
+ * hasher of digests, their bits are already mixed
+ */
+struct DigestHash
+{
+    size_t operator()(const Digest& d) const
+    { return d.lo; }
+};
+
+/**
+ * bounded LRU cache of message verdicts, keyed by message digest. the digest is of the bytes
+ * given, so messages share a result only if they are brought to the same bytes first - the caller
+ * decides what is ignored. a result is only returned for the dictionary version and threshold it
+ * was scored with, so reloads and other thresholds miss.
+ * the cache is split in CACHE_SHARDS shards by digest, each an LRU list with a HashMap index under
+ * its own lock, so concurrent scorers rarely wait on each other
+ */
+class ResultCache
+{
+public:
+    /**
+     * verdict of a message
+     */
+    struct Result
+    {
+        bool spam;
+        int score;
+    };
+
+private:
+    /**
+     * cached result, and its place in the LRU list of its shard
+     */
+    struct Node
+    {
+        Digest key;
+        uint64_t version;
+        int threshold;
+        Result result;
+        uint32_t prev, next;
+    };
+
+    /**
+     * one LRU list, most recently used first
+     */
+    struct Shard
+    {
+        std::mutex lock;
+        HashMap<Digest, uint32_t, FlatLayout, DigestHash> index; //digest -> node
+        std::vector<Node> nodes;
+        uint32_t head, tail;
+        size_t hits, misses, evictions;
+    };
+
+    std::unique_ptr<Shard[]> _shards;
+    size_t _perShard;
+
+    /**
+     * takes a node out of the list
+     * @param s
+     * @param i
+     */
+    static void _unlink(Shard& s, uint32_t i);
+
+    /**
+     * puts a node at the front of the list
+     * @param s
+     * @param i
+     */
+    static void _pushFront(Shard& s, uint32_t i);
+
+    /**
+     *
+     * @param d
+     * @return shard of d
+     */
+    Shard& _shardOf(const Digest& d) const
+    { return _shards[d.hi % CACHE_SHARDS]; }
+
+public:
+    /**
+     * ctor
+     * @param bytes memory cap, entries and index together
+     */
+    explicit ResultCache(size_t bytes);
+
+    ResultCache(const ResultCache& other) = delete;
+
+    ResultCache& operator=(const ResultCache& other) = delete;
+
+    /**
+     *
+     * @param data
+     * @param len
+     * @return digest of bytes, two independent 64 bit string hashes
+     */
+    static Digest digest(const char* data, size_t len);
+
+    /**
+     *
+     * @return bytes one cached result takes, index share included
+     */
+    static size_t entryBytes();
+
+    /**
+     * looks a message up, and marks it recently used
+     * @param d
+     * @param version dictionary version
+     * @param threshold
+     * @param result set if found
+     * @return true if found
+     */
+    bool get(const Digest& d, uint64_t version, int threshold, Result& result);
+
+    /**
+     * caches a result, evicting the least recently used one of its shard when full
+     * @param d
+     * @param version
+     * @param threshold
+     * @param result
+     */
+    void put(const Digest& d, uint64_t version, int threshold, const Result& result);
+
+    /**
+     *
+     * @return max num of cached results
+     */
+    size_t capacity() const
+    { return _perShard * CACHE_SHARDS; }
+
+    /**
+     * writes hit rate counters as a json object
+     * @param os
+     */
+    void toJson(std::ostream& os) const;
+};
+
+#endif //EX3_RESULTCACHE_H
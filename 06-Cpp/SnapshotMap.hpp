@@ -0,0 +1,182 @@
+#ifndef EX3_SNAPSHOTMAP_HPP
+#define EX3_SNAPSHOTMAP_HPP
+
+#include <mutex>
+#include "HashMap.hpp"
+#include "RcuCell.hpp"
+
+/**
+ * read mostly hashmap for dictionaries that are read all the time and change rarely. readers
+ * look up in an immutable snapshot without locks, a writer copies the current map (HashMap copy
+ * ctor), changes the copy off to the side and publishes it as the next snapshot. every snapshot
+ * carries a version, so a reader can tell which one it observed, and compare it to any other map
+ * with HashMap's operator==
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Layout storage policy of the snapshots
+ */
+template<typename KeyT, typename ValueT, typename Layout = FlatLayout>
+class SnapshotMap
+{
+public:
+    using map_type = HashMap<KeyT, ValueT, Layout>;
+
+    /**
+     * one published version of the map
+     */
+    struct snapshot
+    {
+        uint64_t version;
+        map_type map;
+    };
+
+private:
+    RcuCell<snapshot> _cell;
+    std::mutex _writer;
+    uint64_t _version; //guarded by _writer
+
+public:
+    /**
+     * per thread read handle, see RcuCell::Reader
+     */
+    class Reader
+    {
+    private:
+        typename RcuCell<snapshot>::Reader _reader;
+
+    public:
+        /**
+         * ctor
+         * @param reader
+         */
+        explicit Reader(typename RcuCell<snapshot>::Reader && reader) : _reader(std::move(reader))
+        {};
+
+        /**
+         * calls f on the current snapshot, which stays alive until f returns
+         * @param f callable with const snapshot&
+         * @return what f returns
+         */
+        template<typename F>
+        auto read(F&& f) const
+        { return _reader.read(std::forward<F>(f)); }
+
+        /**
+         *
+         * @param k key of type KeyT, or comparable to it
+         * @return if key in current snapshot
+         */
+        template<typename K>
+        bool containsKey(const K& k) const
+        { return read([&k](const snapshot& s) { return s.map.containsKey(k); }); }
+
+        /**
+         *
+         * @param k key of type KeyT, or comparable to it
+         * @param out set to value of key, if found
+         * @param version set to version of the snapshot the lookup ran on, found or not
+         * @return if key in that snapshot
+         */
+        template<typename K>
+        bool tryGet(const K& k, ValueT& out, uint64_t& version) const
+        {
+            return read([&k, &out, &version](const snapshot& s)
+                        {
+                            version = s.version;
+                            const ValueT* v = s.map.get(k);
+                            if (v == nullptr)
+                            {
+                                return false;
+                            }
+                            out = *v;
+                            return true;
+                        });
+        }
+
+        /**
+         *
+         * @param k key of type KeyT, or comparable to it
+         * @param out set to value of key, if found
+         * @return if key in current snapshot
+         */
+        template<typename K>
+        bool tryGet(const K& k, ValueT& out) const
+        {
+            uint64_t version;
+            return tryGet(k, out, version);
+        }
+
+        /**
+         *
+         * @return version of current snapshot
+         */
+        uint64_t version() const
+        { return read([](const snapshot& s) { return s.version; }); }
+    };
+
+    /**
+     * ctor
+     * @param initial first snapshot, version 1
+     * @param readers max num of concurrent Reader handles
+     */
+    explicit SnapshotMap(map_type initial = map_type(), size_t readers = READERS_I) :
+        _cell(std::unique_ptr<snapshot>(new snapshot{1, std::move(initial)}), readers), _version(1)
+    {};
+
+    SnapshotMap(const SnapshotMap& other) = delete;
+
+    SnapshotMap& operator=(const SnapshotMap& other) = delete;
+
+    /**
+     * claims a reader slot, a thread should keep its Reader
+     * @return read handle
+     */
+    Reader reader()
+    { return Reader(_cell.reader()); }
+
+    /**
+     * publishes a whole new map
+     * @param next
+     * @return version of the new snapshot
+     */
+    uint64_t publish(map_type next)
+    {
+        std::lock_guard<std::mutex> guard(_writer);
+        _cell.publish(std::unique_ptr<snapshot>(new snapshot{++_version, std::move(next)}));
+        return _version;
+    }
+
+    /**
+     * copies the current map, lets f change the copy, and publishes it
+     * @param f callable with map_type&
+     * @return version of the new snapshot
+     */
+    template<typename F>
+    uint64_t update(F&& f)
+    {
+        std::lock_guard<std::mutex> guard(_writer);
+        map_type next(_cell.latest().map);
+        f(next);
+        _cell.publish(std::unique_ptr<snapshot>(new snapshot{++_version, std::move(next)}));
+        return _version;
+    }
+
+    /**
+     *
+     * @return version of the latest published snapshot
+     */
+    uint64_t version()
+    {
+        std::lock_guard<std::mutex> guard(_writer);
+        return _version;
+    }
+
+    /**
+     * frees snapshots no reader can see anymore (publish does it too)
+     * @return num of freed snapshots
+     */
+    size_t reclaim()
+    { return _cell.reclaim(); }
+};
+
+#endif //EX3_SNAPSHOTMAP_HPP
@@ -1,14 +1,129 @@
 #include <iostream>
 #include <fstream>
 #include "HashMap.hpp"
+#include "AhoCorasick.h"
+#include "AsciiCase.h"
+#include "TokenDictionary.h"
+#include "WeightedScan.h"
+#include "CompiledDb.h"
+#include "MappedFile.h"
+#include "BatchSource.h"
+#include "WorkerPool.h"
+#include "FrameServer.h"
+#include "RcuCell.hpp"
+#include "ResultCache.h"
 #include <string>
 #include <algorithm>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
 #define NUM_OF_ARGS 4
 #define DATABASE_INDEX 1
 #define MSG_INDEX 2
 #define THRESHOLD_INDEX 3
 #define DELIM ','
+#define COMPILE_CMD "compile"
+#define OUT_INDEX 3
+#define BATCH_CMD "batch"
+#define BATCH_NUM_OF_ARGS 5
+#define BATCH_THRESHOLD_INDEX 3
+#define BATCH_INPUT_INDEX 4
+#define BATCH_WINDOW 4096
+#define SERVE_CMD "serve"
+#define SERVE_SOCKET_INDEX 4
+#define LOADGEN_CMD "loadgen"
+#define LOADGEN_NUM_OF_ARGS 6
+#define LOADGEN_SOCKET_INDEX 2
+#define LOADGEN_MSG_INDEX 3
+#define LOADGEN_CONNECTIONS_INDEX 4
+#define LOADGEN_REQUESTS_INDEX 5
+#define STREAM_CHUNK (64 * 1024)
+#define LOAD_CHUNK_MIN (1024 * 1024)
+#define STATS_FLAG "--stats"
+#define MODE_FLAG "--mode="
+#define MODE_SUBSTRINGS "substrings"
+#define MODE_TOKENS "tokens"
+#define MODE_SCAN "scan"
+#define CACHE_FLAG "--cache="
+#define CACHE_UNIT (1024 * 1024)
+#define USAGE "Usage: SpamDetector [--stats] [--mode=substrings|tokens|scan] <database path> " \
+              "<message path | -> <threshold>\n" \
+              "       SpamDetector compile <database path> <output path>\n" \
+              "       SpamDetector [--stats] [--mode=substrings|tokens|scan] [--cache=<MiB>] batch <database path> " \
+              "<threshold> <directory | file list | mbox | ->\n" \
+              "       SpamDetector [--stats] [--mode=substrings|tokens|scan] [--cache=<MiB>] serve <database path> " \
+              "<threshold> <socket path>\n" \
+              "       SpamDetector loadgen <socket path> <message path> <connections> <requests>\n"
+
+/**
+ * validates one database line and splits it
+ * @param line without its '\n'
+ * @param badStr set to the lowercased bad str
+ * @param points set to its points
+ * @return if line is valid
+ */
+int parseLine(std::string& line, std::string& badStr, int& points)
+{
+    //strip \r
+    if (!line.empty() && line[line.size() - 1] == '\r')
+    {
+        line.erase((line.size() - 1));
+    }
+
+    //validate num of columns
+    size_t cur, prev = 0;
+    cur = line.find(DELIM);
+    if (cur == std::string::npos) //delim do not exist
+    {
+        return EXIT_FAILURE;
+    }
+
+    //parse bad str
+    badStr = line.substr(0, cur);
+    if (badStr.empty())
+    {
+        return EXIT_FAILURE;
+    }
+
+    //parse points
+    std::string pointsStr = line.substr(cur + 1, line.size() - 1);
+    if (pointsStr.empty())
+    {
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        points = std::stoi(pointsStr);
+        if (points < 0)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    catch (std::invalid_argument& e)
+    {
+        return EXIT_FAILURE;
+    }
+    catch (std::out_of_range& e)
+    {
+        return EXIT_FAILURE;
+    }
+
+    //validate no more delims
+    prev = cur + 1;
+    cur = line.find(DELIM, prev);
+    if (cur != std::string::npos)
+    {
+        return EXIT_FAILURE;
+    }
+
+    AsciiCase::toLower(&badStr[0], badStr.size());
+    return EXIT_SUCCESS;
+}
 
 /**
  * parsing db stream content to map
@@ -16,94 +131,916 @@
  * @param map
  * @return if process was successful
  */
-int parseDb(std::fstream& db, HashMap<std::string, int>& map)
+int parseDb(std::istream& db, HashMap<std::string, int, DenseLayout>& map)
 {
-    std::string line;
+    std::string line, badStr;
+    int points;
     while (std::getline(db, line))
     {
-        //strip \r
-        if (line[line.size() - 1] == '\r')
+        if (parseLine(line, badStr, points) == EXIT_FAILURE)
         {
-            line.erase((line.size() - 1));
+            return EXIT_FAILURE;
         }
+        //add pair to map
+        map.try_emplace(std::move(badStr), points);
+    }
+    return EXIT_SUCCESS;
+}
 
-        //validate num of columns
-        size_t cur, prev = 0;
-        cur = line.find(DELIM);
-        if (cur == std::string::npos) //delim do not exist
+/**
+ * pairs parsed from one chunk of a database file, in file order
+ */
+struct DbChunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<std::pair<std::string, int>> pairs;
+};
+
+/**
+ * parses the lines of a chunk
+ * @param chunk
+ * @param failed set once any chunk is invalid, the others stop early then
+ */
+void parseChunk(DbChunk& chunk, std::atomic<bool>& failed)
+{
+    std::string line, badStr;
+    int points;
+    const char* p = chunk.begin;
+    while (p < chunk.end && !failed.load(std::memory_order_relaxed))
+    {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        const char* stop = nl == nullptr ? chunk.end : nl;
+        line.assign(p, stop);
+        if (parseLine(line, badStr, points) == EXIT_FAILURE)
         {
-            return EXIT_FAILURE;
+            failed = true;
+            return;
         }
+        chunk.pairs.emplace_back(std::move(badStr), points);
+        p = stop + 1;
+    }
+}
+
+/**
+ * parses a mapped database file. it is split at line starts into a chunk per core, the chunks are
+ * parsed in parallel, and then added to map in file order, so the first of equal bad strs still
+ * wins. files under LOAD_CHUNK_MIN are parsed as one chunk on this thread
+ * @param file non empty
+ * @param map
+ * @return if process was successful
+ */
+int parseMappedDb(const MappedFile& file, HashMap<std::string, int, DenseLayout>& map)
+{
+    const char* data = file.data();
+    size_t size = file.size();
+    size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t n = std::max<size_t>(1, std::min(threads, size / LOAD_CHUNK_MIN));
 
-        //parse bad str
-        std::string badStr = line.substr(0, cur);
-        if (badStr.empty())
+    std::vector<DbChunk> chunks(n);
+    const char* begin = data;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char* end = data + size * (i + 1) / n;
+        if (i + 1 < n && end > begin)
         {
-            return EXIT_FAILURE;
+            //move the cut past the end of the line it falls in
+            const char* nl = static_cast<const char*>(std::memchr(end - 1, '\n', data + size - (end - 1)));
+            end = nl == nullptr ? data + size : nl + 1;
+        }
+        end = std::max(begin, i + 1 < n ? end : data + size);
+        chunks[i] = DbChunk{begin, end, {}};
+        begin = end;
+    }
+
+    std::atomic<bool> failed(false);
+    if (n == 1)
+    {
+        parseChunk(chunks[0], failed);
+    }
+    else
+    {
+        WorkerPool pool(n);
+        for (DbChunk& chunk : chunks)
+        {
+            pool.submit([&chunk, &failed]
+                        { parseChunk(chunk, failed); });
+        }
+        if (pool.wait() == EXIT_FAILURE)
+        {
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        return EXIT_FAILURE;
+    }
+
+    //one bulk build, the table is sized for all pairs up front
+    size_t total = 0;
+    for (const DbChunk& chunk : chunks)
+    {
+        total += chunk.pairs.size();
+    }
+    map.reserve(map.size() + total);
+    for (DbChunk& chunk : chunks)
+    {
+        for (auto & pair : chunk.pairs)
+        {
+            map.try_emplace(std::move(pair.first), pair.second);
         }
+        std::vector<std::pair<std::string, int>>().swap(chunk.pairs);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * reads a CSV database file into map. regular files are mapped and parsed in parallel, anything
+ * which cannot be mapped (a pipe, or an empty file) is read as a stream
+ * @param path
+ * @param map
+ * @return if process was successful
+ */
+int loadDb(const char* path, HashMap<std::string, int, DenseLayout>& map)
+{
+    std::unique_ptr<MappedFile> file;
+    try
+    {
+        file.reset(new MappedFile(path));
+    }
+    catch (std::invalid_argument& e)
+    {
+        file.reset();
+    }
+    if (file && file->size() > 0)
+    {
+        return parseMappedDb(*file, map);
+    }
+
+    std::fstream db_stream(path);
+
+    //validate files exist
+    if (!db_stream.good())
+    {
+        db_stream.close();
+        return EXIT_FAILURE;
+    }
 
-        //parse points
-        std::string pointsStr = line.substr(cur + 1, line.size() - 1);
-        if (pointsStr.empty())
+    //process db_stream file
+    if (db_stream.peek() != db_stream.eof())
+    {
+        if (parseDb(db_stream, map) == EXIT_FAILURE)
         {
+            db_stream.close();
             return EXIT_FAILURE;
         }
+    }
+    db_stream.close();
+    return EXIT_SUCCESS;
+}
+
+/**
+ * splits map to parallel phrases and points vectors, in database order. the dense layout makes this
+ * a sweep over the pairs alone, however the table is sized
+ * @param map
+ * @param phrases
+ * @param points
+ */
+void collectDb(const HashMap<std::string, int, DenseLayout>& map, std::vector<std::string>& phrases,
+               std::vector<int>& points)
+{
+    phrases.reserve(map.size());
+    points.reserve(map.size());
+    for (const auto & it : map)
+    {
+        phrases.push_back(it.first);
+        points.push_back(it.second);
+    }
+}
+
+/**
+ * compiles the bad words into an aho-corasick automaton, so a msg is scored in one pass
+ * @param map
+ * @return automaton over all bad words
+ */
+AhoCorasick compileDb(const HashMap<std::string, int, DenseLayout>& map)
+{
+    std::vector<std::string> phrases;
+    std::vector<int> points;
+    collectDb(map, phrases, points);
+    return AhoCorasick(phrases, points);
+}
+
+/**
+ * bad words ready for scoring - a compiled database is mapped as is, a CSV one is parsed and
+ * compiled here. in token mode the phrases are indexed by their tokens instead, in scan mode they
+ * are sorted by points
+ */
+struct Dictionary
+{
+    std::unique_ptr<CompiledDb> image;
+    std::unique_ptr<AhoCorasick> built;
+    std::unique_ptr<TokenDictionary> tokens; //set in token mode only
+    std::unique_ptr<WeightedScan> weighted; //set in scan mode only
+    uint64_t version = 0; //bumped by every reload of a served dictionary
+
+    /**
+     *
+     * @return automaton over all bad words
+     */
+    const AhoCorasick& automaton() const
+    { return image ? image->automaton() : *built; }
+};
+
+/**
+ * writes telemetry of the map a CSV database was loaded into, as one json line
+ * @param map nullptr if no map was built (compiled database)
+ * @param os
+ */
+void dumpStats(const HashMap<std::string, int, DenseLayout>* map, std::ostream& os)
+{
+#ifdef HASHMAP_STATS
+    os << "{\"hashmap\": ";
+    if (map == nullptr)
+    {
+        os << "null";
+    }
+    else
+    {
+        map->stats().toJson(os);
+    }
+    os << "}\n";
+#else
+    (void) map;
+    os << "{\"hashmap\": \"disabled, build with -DHASHMAP_STATS\"}\n";
+#endif
+}
 
-        int points;
+/**
+ * writes which case folding kernel this cpu runs, as one json line
+ * @param os
+ */
+void dumpCaseStats(std::ostream& os)
+{ os << "{\"ascii_case\": {\"kernel\": \"" << AsciiCase::kernel() << "\"}}\n"; }
+
+/**
+ * opens a database file of either kind
+ * @param path
+ * @param dict
+ * @param mode MODE_SUBSTRINGS, MODE_TOKENS or MODE_SCAN
+ * @param stats stream for load telemetry, nullptr for none
+ * @return if process was successful
+ */
+int openDictionary(const char* path, Dictionary& dict, const std::string& mode, std::ostream* stats = nullptr)
+{
+    if (stats != nullptr)
+    {
+        dumpCaseStats(*stats);
+    }
+    if (CompiledDb::isCompiled(path))
+    {
         try
         {
-            points = std::stoi(pointsStr);
-            if (points < 0)
-            {
-                return EXIT_FAILURE;
-            }
+            dict.image.reset(new CompiledDb(path));
         }
         catch (std::invalid_argument& e)
         {
             return EXIT_FAILURE;
         }
-        catch (std::out_of_range& e)
+        if (stats != nullptr)
         {
-            return EXIT_FAILURE;
+            dumpStats(nullptr, *stats);
+        }
+        if (mode == MODE_TOKENS || mode == MODE_SCAN)
+        {
+            std::vector<std::string> phrases;
+            std::vector<int> points;
+            for (size_t i = 0; i < dict.image->phrases(); ++i)
+            {
+                phrases.emplace_back(dict.image->phrase(i));
+                points.push_back(dict.image->points(i));
+            }
+            if (mode == MODE_TOKENS)
+            {
+                dict.tokens.reset(new TokenDictionary(phrases, points));
+            }
+            else
+            {
+                dict.weighted.reset(new WeightedScan(phrases, points));
+            }
         }
+        return EXIT_SUCCESS;
+    }
 
-        //validate no more delims
-        prev = cur + 1;
-        cur = line.find(DELIM, prev);
-        if (cur != std::string::npos)
+    HashMap<std::string, int, DenseLayout> badWords;
+    if (loadDb(path, badWords) == EXIT_FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+    if (stats != nullptr)
+    {
+        dumpStats(&badWords, *stats);
+    }
+    if (mode == MODE_TOKENS || mode == MODE_SCAN)
+    {
+        std::vector<std::string> phrases;
+        std::vector<int> points;
+        collectDb(badWords, phrases, points);
+        if (mode == MODE_TOKENS)
         {
-            return EXIT_FAILURE;
+            dict.tokens.reset(new TokenDictionary(phrases, points));
+        }
+        else
+        {
+            dict.weighted.reset(new WeightedScan(phrases, points));
         }
+        return EXIT_SUCCESS;
+    }
+    dict.built.reset(new AhoCorasick(compileDb(badWords)));
+    return EXIT_SUCCESS;
+}
 
-        //add pair to map
-        std::transform(badStr.begin(), badStr.end(), badStr.begin(), [](unsigned char c){ return std::tolower(c); });
-        map.insert(badStr, points);
+/**
+ * parses threshold arg, a positive int
+ * @param str
+ * @param threshold
+ * @return if process was successful
+ */
+int parseThreshold(const std::string& str, int& threshold)
+{
+    try
+    {
+        threshold = std::stoi(str);
+    }
+    catch (std::invalid_argument& e)
+    {
+        return EXIT_FAILURE;
+    }
+    catch (std::out_of_range& e)
+    {
+        return EXIT_FAILURE;
+    }
+    return threshold <= 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * compile subcommand - validates a CSV database once and writes it as a compiled database, which
+ * later runs map instead of parsing
+ * @param dbPath CSV database
+ * @param outPath compiled database
+ * @return if process was successful
+ */
+int compileMain(const char* dbPath, const char* outPath)
+{
+    HashMap<std::string, int, DenseLayout> badWords;
+    if (loadDb(dbPath, badWords) == EXIT_FAILURE)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> phrases;
+    std::vector<int> points;
+    collectDb(badWords, phrases, points);
+    if (CompiledDb::write(outPath, phrases, points) == EXIT_FAILURE)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
 }
 
+/**
+ * scan state of one thread, over whichever index the dictionary was opened with
+ */
+class Scorer
+{
+private:
+    std::unique_ptr<AhoCorasick::Scanner> _substrings;
+    std::unique_ptr<TokenDictionary::Scanner> _tokens;
+    std::unique_ptr<WeightedScan::Scanner> _weighted;
+    std::vector<char> _chunk;
+    std::string _msg; //streamed msg which fit in one piece, scored whole
+    ResultCache* _cache;
+    uint64_t _version; //of the dictionary, results are cached under it
+    bool _hit; //last msg was found in cache
+    int _hitScore;
+
+    /**
+     * scores a whole msg, without the cache
+     * @param msg
+     * @param threshold
+     * @return true if msg is spam
+     */
+    bool _scan(std::string& msg, int threshold)
+    {
+        _hit = false;
+        if (_tokens)
+        {
+            return _tokens->scan(&msg[0], msg.size(), threshold);
+        }
+        if (_weighted)
+        {
+            return _weighted->scan(&msg[0], msg.size(), threshold);
+        }
+        _substrings->reset();
+        return _substrings->feed(msg.data(), msg.size(), threshold);
+    }
+
+    /**
+     * scores the next piece of a streamed msg
+     * @param data
+     * @param len
+     * @param threshold
+     * @return true if msg is spam
+     */
+    bool _feed(const char* data, size_t len, int threshold)
+    {
+        if (_tokens)
+        {
+            return _tokens->feed(data, len, threshold);
+        }
+        if (_weighted)
+        {
+            return _weighted->feed(data, len, threshold);
+        }
+        return _substrings->feed(data, len, threshold);
+    }
+
+public:
+    /**
+     * ctor
+     * @param dict
+     * @param cache of results, shared by scorers, nullptr for none
+     */
+    explicit Scorer(const Dictionary& dict, ResultCache* cache = nullptr) : _cache(cache), _version(dict.version),
+                                                                          _hit(false), _hitScore(0)
+    {
+        if (dict.tokens)
+        {
+            _tokens.reset(new TokenDictionary::Scanner(*dict.tokens));
+        }
+        else if (dict.weighted)
+        {
+            _weighted.reset(new WeightedScan::Scanner(*dict.weighted));
+        }
+        else
+        {
+            _substrings.reset(new AhoCorasick::Scanner(dict.automaton()));
+        }
+    }
+
+    /**
+     * scores a whole msg. every bad word counts once, however many times it appears. with a cache,
+     * the msg is brought to the form its mode matches on and looked up by digest first, so msgs
+     * differing only in what the mode ignores share a verdict - in token mode the normalized msg,
+     * which drops case, spacing and punctuation, in the other modes the lowercased msg, which only
+     * drops ascii case, as spacing and punctuation are part of their phrases
+     * @param msg normalized in place in token mode, and cut to its normalized length with a cache,
+     * lowercased in scan mode or with a cache, kept as is otherwise
+     * @param threshold
+     * @return true if msg is spam, score() holds the score reached
+     */
+    bool score(std::string& msg, int threshold)
+    {
+        if (_cache == nullptr)
+        {
+            return _scan(msg, threshold);
+        }
+        if (_tokens)
+        {
+            msg.resize(_tokens->prepare(&msg[0], msg.size()));
+        }
+        else
+        {
+            AsciiCase::toLower(&msg[0], msg.size());
+        }
+        Digest digest = ResultCache::digest(msg.data(), msg.size());
+        ResultCache::Result result;
+        if (_cache->get(digest, _version, threshold, result))
+        {
+            _hit = true;
+            _hitScore = result.score;
+            return result.spam;
+        }
+        _hit = false;
+        bool spam = _tokens ? _tokens->probe(msg.data(), threshold) : _scan(msg, threshold);
+        _cache->put(digest, _version, threshold, ResultCache::Result{spam, score()});
+        return spam;
+    }
+
+    /**
+     * scores a msg read from a stream in STREAM_CHUNK pieces, so memory stays the same however
+     * long it is. the scan state is carried from piece to piece, so phrases across piece edges
+     * still match. reading stops once the msg is spam. a msg which fits in one piece is scored as a
+     * whole msg when there is a cache, so it can be looked up, and in scan mode, so the search can
+     * stop once the phrases left cannot reach threshold. longer ones are streamed uncached
+     * @param in
+     * @param threshold
+     * @return true if msg is spam, score() holds the score reached
+     */
+    bool score(std::istream& in, int threshold)
+    {
+        _chunk.resize(STREAM_CHUNK);
+        _hit = false;
+        if (_tokens)
+        {
+            _tokens->reset();
+        }
+        else if (_weighted)
+        {
+            _weighted->reset();
+        }
+        else
+        {
+            _substrings->reset();
+        }
+        bool first = true;
+        while (in.read(_chunk.data(), _chunk.size()) || in.gcount() > 0)
+        {
+            size_t n = in.gcount();
+            if (first && (_cache != nullptr || _weighted) && in.eof())
+            {
+                _msg.assign(_chunk.data(), n);
+                return score(_msg, threshold);
+            }
+            first = false;
+            if (_feed(_chunk.data(), n, threshold))
+            {
+                return true;
+            }
+        }
+        return _tokens && _tokens->finish(threshold);
+    }
+
+    /**
+     *
+     * @return score of last msg
+     */
+    int score() const
+    { return _hit ? _hitScore : _tokens ? _tokens->score() : _weighted ? _weighted->score() : _substrings->score(); }
+
+    /**
+     *
+     * @return num of dictionary entries searched for last msg, scan mode only. none if it was cached
+     */
+    size_t evaluated() const
+    { return _weighted && !_hit ? _weighted->evaluated() : 0; }
+};
+
+/**
+ * writes how much of the dictionary scan mode searched, as one json line
+ * @param messages
+ * @param evaluated entries searched, summed over messages
+ * @param entries entries in dictionary
+ * @param os
+ */
+void dumpScanStats(size_t messages, size_t evaluated, size_t entries, std::ostream& os)
+{
+    os << "{\"scan\": {\"messages\": " << messages << ", \"evaluated\": " << evaluated << ", \"entries\": "
+       << entries << "}}\n";
+}
+
+/**
+ * writes result cache hit rates, as one json line
+ * @param cache
+ * @param os
+ */
+void dumpCacheStats(const ResultCache& cache, std::ostream& os)
+{
+    os << "{\"cache\": ";
+    cache.toJson(os);
+    os << "}\n";
+}
+
 /**
  * checks if givem msg is spam, based on dictionary and threshold
+ * @param stats stream for scan telemetry, nullptr for none
  */
-bool isSpam(std::fstream& msg_stream, int threshold, const HashMap<std::string, int>& map)
+bool isSpam(std::istream& msg_stream, int threshold, const Dictionary& dict, std::ostream* stats = nullptr)
 {
-    int score = 0;
-    std::string msg;
-    msg.assign(std::istreambuf_iterator<char>(msg_stream), (std::istreambuf_iterator<char>()));
-    std::transform(msg.begin(), msg.end(), msg.begin(), [](unsigned char c){ return std::tolower(c); });
+    Scorer scorer(dict);
+    bool spam = scorer.score(msg_stream, threshold);
+    if (stats != nullptr && dict.weighted)
+    {
+        dumpScanStats(1, scorer.evaluated(), dict.weighted->phrases(), *stats);
+    }
+    return spam;
+}
 
-    for (const auto & it : map)
+/**
+ * scores a window of batch items on the pool. every worker keeps one scorer and pulls the next
+ * unscored item, so long and short messages even out
+ * @param items
+ * @param threshold
+ * @param dict
+ * @param pool
+ * @param cache nullptr for none
+ * @return EXIT_FAILURE if scoring threw, the window is then only partly scored
+ */
+int scoreBatch(std::vector<BatchItem>& items, int threshold, const Dictionary& dict, WorkerPool& pool,
+                ResultCache* cache)
+{
+    std::atomic<size_t> next(0);
+    for (size_t w = 0; w < pool.size(); ++w)
+    {
+        pool.submit([&items, &next, &dict, threshold, cache]
+                    {
+                        Scorer scorer(dict, cache);
+                        for (size_t i = next++; i < items.size(); i = next++)
+                        {
+                            BatchItem& item = items[i];
+                            if (item.loaded)
+                            {
+                                item.spam = scorer.score(item.body, threshold);
+                                std::string().swap(item.body);
+                            }
+                            else
+                            {
+                                std::ifstream msg_stream(item.name, std::ios::binary);
+                                if (!msg_stream.good())
+                                {
+                                    continue;
+                                }
+                                item.spam = scorer.score(msg_stream, threshold);
+                            }
+                            item.valid = true;
+                            item.score = scorer.score();
+                            item.evaluated = scorer.evaluated();
+                        }
+                    });
+    }
+    return pool.wait();
+}
+
+/**
+ * batch subcommand - loads the dictionary once, scores every message of the input on a worker
+ * pool, and prints "path,SPAM|NOT_SPAM,score" lines in input order. the score is the one reached
+ * when the verdict was made, scanning stops at the threshold. unreadable messages are reported
+ * on stderr
+ * @param dbPath
+ * @param thresholdStr
+ * @param input
+ * @param mode MODE_SUBSTRINGS, MODE_TOKENS or MODE_SCAN
+ * @param stats stream for dictionary, scan and cache telemetry, nullptr for none
+ * @param cacheBytes memory cap of the result cache, 0 for none
+ * @return if process was successful
+ */
+int batchMain(const char* dbPath, const char* thresholdStr, const char* input, const std::string& mode,
+              std::ostream* stats, size_t cacheBytes)
+{
+    Dictionary dict;
+    int threshold;
+    if (openDictionary(dbPath, dict, mode, stats) == EXIT_FAILURE ||
+        parseThreshold(thresholdStr, threshold) == EXIT_FAILURE)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<BatchSource> source;
+    try
+    {
+        source.reset(new BatchSource(input));
+    }
+    catch (std::invalid_argument& e)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<ResultCache> cache(cacheBytes > 0 ? new ResultCache(cacheBytes) : nullptr);
+    WorkerPool pool;
+    std::vector<BatchItem> items(BATCH_WINDOW);
+    size_t total = 0, evaluated = 0;
+    int result = EXIT_SUCCESS;
+    while (true)
+    {
+        //windows keep memory bounded while output stays in input order
+        size_t n = 0;
+        while (n < items.size() && source->next(items[n]))
+        {
+            ++n;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        items.resize(n);
+        if (scoreBatch(items, threshold, dict, pool, cache.get()) == EXIT_FAILURE)
+        {
+            std::cerr << "Invalid input\n";
+            return EXIT_FAILURE;
+        }
+
+        for (const BatchItem& item : items)
+        {
+            if (!item.valid)
+            {
+                std::cerr << "Invalid input: " << item.name << "\n";
+                result = EXIT_FAILURE;
+                continue;
+            }
+            std::cout << item.name << "," << (item.spam ? "SPAM" : "NOT_SPAM") << "," << item.score << "\n";
+            evaluated += item.evaluated;
+        }
+        total += n;
+        items.resize(BATCH_WINDOW);
+    }
+
+    if (stats != nullptr && dict.weighted)
+    {
+        dumpScanStats(total, evaluated, dict.weighted->phrases(), *stats);
+    }
+    if (stats != nullptr && cache)
     {
-        if (msg.find(it.first, 0) != std::string::npos)
+        dumpCacheStats(*cache, *stats);
+    }
+    return result;
+}
+
+/**
+ * scoring state of a served dictionary, reused by one request at a time
+ */
+struct Session
+{
+    RcuCell<Dictionary>::Reader reader;
+    uint64_t version;
+    std::unique_ptr<Scorer> scorer; //over the dictionary of version
+};
+
+/**
+ * serve subcommand - loads the dictionary once and scores messages sent over a unix domain socket
+ * (see FrameServer) until SIGINT or SIGTERM. a request is a msg, its reply "SPAM,score" or
+ * "NOT_SPAM,score". SIGHUP reloads the database; requests keep being scored with the old
+ * dictionary until the new one is ready, and a database which fails to load keeps the old one.
+ * cached results are tagged with the dictionary version, so a reload leaves them all stale
+ * @param dbPath
+ * @param thresholdStr
+ * @param socketPath
+ * @param mode MODE_SUBSTRINGS, MODE_TOKENS or MODE_SCAN
+ * @param stats stream for dictionary and cache telemetry, nullptr for none
+ * @param cacheBytes memory cap of the result cache, 0 for none
+ * @return if process was successful
+ */
+int serveMain(const char* dbPath, const char* thresholdStr, const char* socketPath, const std::string& mode,
+              std::ostream* stats, size_t cacheBytes)
+{
+    std::unique_ptr<Dictionary> first(new Dictionary());
+    int threshold;
+    if (openDictionary(dbPath, *first, mode, stats) == EXIT_FAILURE ||
+        parseThreshold(thresholdStr, threshold) == EXIT_FAILURE)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+    RcuCell<Dictionary> dicts(std::move(first));
+    std::mutex sessionsLock;
+    std::vector<std::unique_ptr<Session>> sessions; //idle ones
+    std::unique_ptr<ResultCache> cache(cacheBytes > 0 ? new ResultCache(cacheBytes) : nullptr);
+
+    auto handler = [&dicts, &sessionsLock, &sessions, &cache, threshold](std::string& msg)
+    {
+        std::unique_ptr<Session> session;
+        {
+            std::lock_guard<std::mutex> guard(sessionsLock);
+            if (!sessions.empty())
+            {
+                session = std::move(sessions.back());
+                sessions.pop_back();
+            }
+        }
+        if (!session)
         {
-            score += it.second;
+            session.reset(new Session{dicts.reader(), 0, nullptr});
         }
-        if (score >= threshold)
+
+        std::string reply = session->reader.read([&session, &cache, &msg, threshold](const Dictionary& dict)
+                                                 {
+                                                     if (!session->scorer || session->version != dict.version)
+                                                     {
+                                                         session->scorer.reset(new Scorer(dict, cache.get()));
+                                                         session->version = dict.version;
+                                                     }
+                                                     bool spam = session->scorer->score(msg, threshold);
+                                                     return std::string(spam ? "SPAM," : "NOT_SPAM,") +
+                                                            std::to_string(session->scorer->score());
+                                                 });
+
+        std::lock_guard<std::mutex> guard(sessionsLock);
+        sessions.push_back(std::move(session));
+        return reply;
+    };
+
+    uint64_t version = 0;
+    auto reload = [&dicts, &version, dbPath, &mode]
+    {
+        std::unique_ptr<Dictionary> next(new Dictionary());
+        if (openDictionary(dbPath, *next, mode) == EXIT_FAILURE)
         {
-            return true;
+            std::cerr << "Reload failed, keeping the loaded dictionary\n";
+            return;
         }
+        next->version = ++version;
+        dicts.publish(std::move(next));
+        std::cerr << "Reloaded dictionary, version " << version << "\n";
+    };
+
+    try
+    {
+        //every worker holds a reader slot of the cell while it scores
+        size_t workers = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), READERS_I));
+        FrameServer server(socketPath, workers);
+        server.run(handler, reload);
+    }
+    catch (std::invalid_argument& e)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+    if (stats != nullptr && cache)
+    {
+        dumpCacheStats(*cache, *stats);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * loadgen subcommand - sends a msg to a serving SpamDetector over many connections at once, each
+ * sending its next request once the last was answered, and prints the request rate and latency
+ * percentiles
+ * @param socketPath
+ * @param msgPath
+ * @param connectionsStr
+ * @param requestsStr total requests, split among connections
+ * @return if process was successful
+ */
+int loadgenMain(const char* socketPath, const char* msgPath, const char* connectionsStr, const char* requestsStr)
+{
+    std::ifstream msg_stream(msgPath, std::ios::binary);
+    int connections, requests;
+    //counts follow the rules of a threshold, positive ints
+    if (!msg_stream.good() || parseThreshold(connectionsStr, connections) == EXIT_FAILURE ||
+        parseThreshold(requestsStr, requests) == EXIT_FAILURE)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+    std::string msg;
+    msg.assign(std::istreambuf_iterator<char>(msg_stream), (std::istreambuf_iterator<char>()));
+
+    std::vector<std::vector<double>> latencies(connections); //microseconds, per connection
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < connections; ++c)
+    {
+        int share = requests / connections + (c < requests % connections ? 1 : 0);
+        clients.emplace_back([&latencies, &errors, &msg, socketPath, share, c]
+                             {
+                                 try
+                                 {
+                                     FrameClient client(socketPath);
+                                     std::string reply;
+                                     latencies[c].reserve(share);
+                                     for (int i = 0; i < share; ++i)
+                                     {
+                                         auto sent = std::chrono::steady_clock::now();
+                                         if (!client.call(msg, reply))
+                                         {
+                                             errors += share - i;
+                                             return;
+                                         }
+                                         latencies[c].push_back(std::chrono::duration<double, std::micro>(
+                                             std::chrono::steady_clock::now() - sent).count());
+                                     }
+                                 }
+                                 catch (std::invalid_argument& e)
+                                 {
+                                     errors += share;
+                                 }
+                             });
+    }
+    for (std::thread& t : clients)
+    {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto & l : latencies)
+    {
+        all.insert(all.end(), l.begin(), l.end());
     }
-    return false;
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p)
+    { return all.empty() ? 0 : all[std::min(all.size() - 1, (size_t) (p / 100 * all.size()))]; };
+
+    std::cout << all.size() << " requests, " << errors << " errors, " << (seconds > 0 ? all.size() / seconds : 0)
+              << " req/s (" << connections << " connections)\n";
+    std::cout << "latency us: p50 " << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99)
+              << ", p99.9 " << percentile(99.9) << ", max " << (all.empty() ? 0 : all.back()) << "\n";
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 
@@ -118,88 +1055,115 @@ bool isSpam(std::fstream& msg_stream, int threshold, const HashMap<std::string,
  */
 int main(int argc, char* argv[])
 {
+    //telemetry of the dictionary goes to stderr as json
+    std::ostream* stats = nullptr;
+    std::string mode = MODE_SUBSTRINGS;
+    size_t cacheBytes = 0;
+    while (argc > 1 && std::string(argv[1]).compare(0, 2, "--") == 0)
+    {
+        std::string flag = argv[1];
+        std::string value = flag.compare(0, std::strlen(MODE_FLAG), MODE_FLAG) == 0 ?
+                            flag.substr(std::strlen(MODE_FLAG)) : "";
+        int mib;
+        if (flag == STATS_FLAG)
+        {
+            stats = &std::cerr;
+        }
+        else if (flag.compare(0, std::strlen(CACHE_FLAG), CACHE_FLAG) == 0 &&
+                 parseThreshold(flag.substr(std::strlen(CACHE_FLAG)), mib) == EXIT_SUCCESS)
+        {
+            //the cache pays off over many msgs, a single msg run ignores it
+            cacheBytes = (size_t) mib * CACHE_UNIT;
+        }
+        else if (value == MODE_SUBSTRINGS || value == MODE_TOKENS || value == MODE_SCAN)
+        {
+            mode = value;
+        }
+        else
+        {
+            std::cerr << USAGE;
+            return EXIT_FAILURE;
+        }
+        ++argv, --argc;
+    }
+
     //validate num of args
+    if (argc == BATCH_NUM_OF_ARGS && std::string(argv[1]) == BATCH_CMD)
+    {
+        return batchMain(argv[DATABASE_INDEX + 1], argv[BATCH_THRESHOLD_INDEX], argv[BATCH_INPUT_INDEX], mode,
+                         stats, cacheBytes);
+    }
+    if (argc == BATCH_NUM_OF_ARGS && std::string(argv[1]) == SERVE_CMD)
+    {
+        return serveMain(argv[DATABASE_INDEX + 1], argv[BATCH_THRESHOLD_INDEX], argv[SERVE_SOCKET_INDEX], mode,
+                         stats, cacheBytes);
+    }
+    if (argc == LOADGEN_NUM_OF_ARGS && std::string(argv[1]) == LOADGEN_CMD)
+    {
+        return loadgenMain(argv[LOADGEN_SOCKET_INDEX], argv[LOADGEN_MSG_INDEX], argv[LOADGEN_CONNECTIONS_INDEX],
+                           argv[LOADGEN_REQUESTS_INDEX]);
+    }
     if (argc != NUM_OF_ARGS)
     {
-        std::cerr << "Usage: SpamDetector <database path> <message path> <threshold>\n";
+        std::cerr << USAGE;
         return EXIT_FAILURE;
     }
+    if (std::string(argv[1]) == COMPILE_CMD)
+    {
+        return compileMain(argv[DATABASE_INDEX + 1], argv[OUT_INDEX]);
+    }
 
     //process database file
-    std::fstream db_stream(argv[DATABASE_INDEX]);
-
-    //validate files exist
-    if (!db_stream.good())
+    Dictionary dict;
+    if (openDictionary(argv[DATABASE_INDEX], dict, mode, stats) == EXIT_FAILURE)
     {
         std::cerr << "Invalid input\n";
-        db_stream.close();
         return EXIT_FAILURE;
     }
 
-    //process db_stream file
-    HashMap<std::string, int> badWords;
-    if (db_stream.peek() != db_stream.eof())
+    //"-" reads the msg from stdin
+    bool fromStdin = std::string(argv[MSG_INDEX]) == STDIN_PATH;
+    std::fstream msg_file;
+    if (!fromStdin)
     {
-        if (parseDb(db_stream, badWords) == EXIT_FAILURE)
-        {
-            std::cerr << "Invalid input\n";
-            db_stream.close();
-            return EXIT_FAILURE;
-        }
+        msg_file.open(argv[MSG_INDEX]);
     }
-    db_stream.close();
-
-    std::fstream msg_stream(argv[MSG_INDEX]);
+    std::istream& msg_stream = fromStdin ? std::cin : static_cast<std::istream&>(msg_file);
     std::string threshold_str = argv[THRESHOLD_INDEX];
 
     //validate files exist
     if (!msg_stream.good())
     {
         std::cerr << "Invalid input\n";
-        msg_stream.close();
+        msg_file.close();
         return EXIT_FAILURE;
     }
 
     //process msg_stream file
     if (msg_stream.peek() == msg_stream.eof())
     {
-        msg_stream.close();
+        msg_file.close();
         return EXIT_SUCCESS;
     }
 
     //validate threshold_str
     int threshold;
-    try
-    {
-        threshold = std::stoi(threshold_str);
-        if (threshold <= 0)
-        {
-            std::cerr << "Invalid input\n";
-            return EXIT_FAILURE;
-        }
-    }
-    catch (std::invalid_argument& e)
-    {
-        std::cerr << "Invalid input\n";
-        msg_stream.close();
-        return EXIT_FAILURE;
-    }
-    catch (std::out_of_range& e)
+    if (parseThreshold(threshold_str, threshold) == EXIT_FAILURE)
     {
         std::cerr << "Invalid input\n";
-        msg_stream.close();
+        msg_file.close();
         return EXIT_FAILURE;
     }
 
     //check if msg is spam
-    if (isSpam(msg_stream, threshold, badWords))
+    if (isSpam(msg_stream, threshold, dict, stats))
     {
-        msg_stream.close();
+        msg_file.close();
         std::cout << "SPAM\n";
     }
     else
     {
-        msg_stream.close();
+        msg_file.close();
         std::cout << "NOT_SPAM\n";
     }
 }
@@ -0,0 +1,334 @@
+#ifndef EX3_STATICHASHMAP_HPP
+#define EX3_STATICHASHMAP_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <iostream>
+#include "HashMap.hpp"
+
+#define CHD_LAMBDA 5
+#define CHD_SPARE 16
+#define CHD_TRIES 65536
+#define CHD_ATTEMPTS 8
+#define CHD_EMPTY 0
+
+/**
+ * immutable map over a perfect hash (CHD style). keys are split in buckets of CHD_LAMBDA keys on
+ * average, and every bucket gets a 16 bit displacement, chosen at build so all its keys land in
+ * free slots of their own - about 3.2 bits of hash metadata per key. every slot has a one byte
+ * fingerprint of its key's hash, kept apart from the pairs so the fingerprints stay in cache. a
+ * lookup reads the displacement of its bucket and then probes exactly one slot - its fingerprint
+ * turns away almost every missing key, and the pair is only read on a match.
+ * there are n / CHD_SPARE more slots than keys, which keeps the displacement search short
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Hash stateless hasher of keys, full 64 bit output
+ */
+template<typename KeyT, typename ValueT, typename Hash = KeyHash<KeyT>>
+class StaticHashMap
+{
+private:
+    using pair = std::pair<KeyT, ValueT>;
+
+    template<typename K>
+    using LookupKey = std::enable_if_t<std::is_same<K, KeyT>::value || IsTransparent<Hash>::value>;
+
+    std::vector<uint16_t> _disp; //displacement of every bucket
+    std::vector<pair> _slots;
+    std::vector<uint8_t> _fingerprints; //of the key in every slot, CHD_EMPTY if there is none
+    int _size;
+
+    /**
+     * multiplies a 32 bit hash into [0, n), no division
+     * @param hash32
+     * @param n at most 2^32
+     * @return hash32 scaled to n
+     */
+    static size_t _range(uint64_t hash32, size_t n)
+    { return (size_t) ((hash32 * n) >> 32); }
+
+    /**
+     *
+     * @param hash full hash of key
+     * @return fingerprint of key, never CHD_EMPTY
+     */
+    static uint8_t _fingerprint(uint64_t hash)
+    {
+        uint8_t f = (uint8_t) (hash >> 16);
+        return f == CHD_EMPTY ? CHD_EMPTY + 1 : f;
+    }
+
+    /**
+     *
+     * @param hash full hash of key
+     * @param disp displacement of its bucket
+     * @param slots
+     * @return slot of key
+     */
+    static size_t _slotOf(uint64_t hash, uint16_t disp, size_t slots)
+    { return _range(StringHash::hashWord(hash + disp) >> 32, slots); }
+
+    /**
+     *
+     * @param k
+     * @return value of key, nullptr if key is not in map
+     */
+    template<typename K>
+    const ValueT* _find(const K& k) const;
+
+public:
+    /**
+     * default ctor, empty map
+     */
+    StaticHashMap() : _size(0)
+    {};
+
+    /**
+     * builds map from keys and values, later duplicates override earlier ones.
+     * throws exception if sizes differ, or if two keys have the same full hash
+     * @param keys
+     * @param values
+     */
+    StaticHashMap(const std::vector<KeyT>& keys, const std::vector<ValueT>& values);
+
+    /**
+     *
+     * @return num of pairs
+     */
+    int size() const
+    { return _size; }
+
+    /**
+     *
+     * @return if map is empty
+     */
+    bool empty() const
+    { return _size == 0; }
+
+    /**
+     *
+     * @return bits of hash metadata (displacements) per key, fingerprints not counted
+     */
+    double bitsPerKey() const
+    { return empty() ? 0 : _disp.size() * 16 / static_cast<double>(_size); }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @return if key in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    bool containsKey(const K& k) const
+    { return _find(k) != nullptr; }
+
+    bool containsKey(const KeyT& k) const
+    { return containsKey<KeyT>(k); }
+
+    /**
+     *
+     * @param k key of type KeyT, or comparable to it
+     * @return value of given key, throws exception if key is not in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    const ValueT& at(const K& k) const;
+
+    const ValueT& at(const KeyT& k) const
+    { return at<KeyT>(k); }
+
+    /**
+     * lookup that does not throw
+     * @param k key of type KeyT, or comparable to it
+     * @return pointer to value of given key, nullptr if key is not in map
+     */
+    template<typename K, typename = LookupKey<K>>
+    const ValueT* get(const K& k) const
+    { return _find(k); }
+
+    const ValueT* get(const KeyT& k) const
+    { return get<KeyT>(k); }
+
+    /**
+     * applies f to every pair
+     * @param f callable with (const KeyT&, const ValueT&)
+     */
+    template<typename F>
+    void forEach(F f) const
+    {
+        for (size_t i = 0; i < _slots.size(); ++i)
+        {
+            if (_fingerprints[i] != CHD_EMPTY)
+            {
+                f(_slots[i].first, _slots[i].second);
+            }
+        }
+    }
+};
+
+/**
+ * ctor
+ * @tparam KeyT
+ * @tparam ValueT
+ * @tparam Hash
+ * @param keys
+ * @param values
+ */
+template<typename KeyT, typename ValueT, typename Hash>
+StaticHashMap<KeyT, ValueT, Hash>::StaticHashMap(const std::vector<KeyT>& keys, const std::vector<ValueT>& values) :
+    _size(0)
+{
+    if (keys.size() != values.size() || keys.size() >= UINT32_MAX - keys.size() / CHD_SPARE)
+    {
+        std::cerr << "exiting ctor due to illegal params\n";
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //last index of every distinct key, equal keys would want the same slot
+    HashMap<KeyT, size_t, FlatLayout, Hash> last;
+    last.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        last.insert_or_assign(keys[i], i);
+    }
+    std::vector<size_t> index;
+    std::vector<uint64_t> hashes;
+    index.reserve(last.size());
+    hashes.reserve(last.size());
+    for (auto it = last.cbegin(); it != last.cend(); ++it)
+    {
+        index.push_back(it->second);
+        hashes.push_back(Hash{}(it->first));
+    }
+    size_t n = index.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    //keys grouped by bucket, bucket b holds members[first[b] .. first[b + 1]). buckets are placed
+    //largest first, while most slots are still free
+    size_t buckets = (n + CHD_LAMBDA - 1) / CHD_LAMBDA;
+    std::vector<uint32_t> first(buckets + 1, 0), members(n), order(buckets);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ++first[_range(hashes[i] >> 32, buckets) + 1];
+    }
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        first[b + 1] += first[b];
+        order[b] = (uint32_t) b;
+    }
+    std::vector<uint32_t> cursor(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        members[cursor[_range(hashes[i] >> 32, buckets)]++] = (uint32_t) i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&first](uint32_t a, uint32_t b)
+    { return first[a + 1] - first[a] > first[b + 1] - first[b]; });
+
+    //a failed attempt only happens with full hash collisions or extreme bad luck, more slots are
+    //tried then. the search runs on a bitmap of taken slots, small enough to stay in cache
+    std::vector<uint64_t> taken;
+    std::vector<size_t> tried;
+    size_t slots = 0;
+    bool placed = false;
+    for (size_t attempt = 0; attempt < CHD_ATTEMPTS && !placed; ++attempt)
+    {
+        slots = n + n / CHD_SPARE + attempt * (n / CHD_SPARE + 1);
+        _disp.assign(buckets, 0);
+        taken.assign((slots + 63) / 64, 0);
+        placed = true;
+        for (size_t b : order)
+        {
+            bool fits = first[b] == first[b + 1];
+            for (size_t d = 0; d < CHD_TRIES && !fits; ++d)
+            {
+                fits = true;
+                tried.clear();
+                for (size_t m = first[b]; m < first[b + 1]; ++m)
+                {
+                    size_t s = _slotOf(hashes[members[m]], (uint16_t) d, slots);
+                    uint64_t bit = uint64_t(1) << (s % 64);
+                    if (taken[s / 64] & bit)
+                    {
+                        fits = false;
+                        break;
+                    }
+                    taken[s / 64] |= bit;
+                    tried.push_back(s);
+                }
+                if (fits)
+                {
+                    _disp[b] = (uint16_t) d;
+                }
+                else
+                {
+                    for (size_t s : tried)
+                    {
+                        taken[s / 64] &= ~(uint64_t(1) << (s % 64));
+                    }
+                }
+            }
+            if (!fits)
+            {
+                placed = false;
+                break;
+            }
+        }
+    }
+    if (!placed)
+    {
+        std::cerr << "exiting ctor due to illegal params\n";
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    _slots.resize(slots);
+    _fingerprints.assign(slots, CHD_EMPTY);
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        for (size_t m = first[b]; m < first[b + 1]; ++m)
+        {
+            uint32_t i = members[m];
+            size_t s = _slotOf(hashes[i], _disp[b], slots);
+            _slots[s] = pair(keys[index[i]], values[index[i]]);
+            _fingerprints[s] = _fingerprint(hashes[i]);
+        }
+    }
+    _size = (int) n;
+}
+
+template<typename KeyT, typename ValueT, typename Hash>
+template<typename K>
+const ValueT* StaticHashMap<KeyT, ValueT, Hash>::_find(const K& k) const
+{
+    if (_size == 0)
+    {
+        return nullptr;
+    }
+    uint64_t hash = Hash{}(k);
+    size_t i = _slotOf(hash, _disp[_range(hash >> 32, _disp.size())], _slots.size());
+
+    //the fingerprint turns away almost every missing key, the pair is only read on a match
+    if (_fingerprints[i] != _fingerprint(hash))
+    {
+        return nullptr;
+    }
+    const pair& p = _slots[i];
+    return p.first == k ? &p.second : nullptr;
+}
+
+template<typename KeyT, typename ValueT, typename Hash>
+template<typename K, typename>
+const ValueT& StaticHashMap<KeyT, ValueT, Hash>::at(const K& k) const
+{
+    const ValueT* v = _find(k);
+    if (v != nullptr)
+    {
+        return *v;
+    }
+    std::cerr << "exiting at() due to exception\n";
+    throw std::out_of_range("exiting at() due to exception\n");
+}
+
+#endif //EX3_STATICHASHMAP_HPP
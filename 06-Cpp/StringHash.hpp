@@ -0,0 +1,164 @@
+#ifndef EX3_STRINGHASH_HPP
+#define EX3_STRINGHASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#define WY_SECRET0 0x2D358DCCAA6C78A5ULL
+#define WY_SECRET1 0x8BB84B93962EACC9ULL
+#define WY_SECRET2 0x4B33A62ED433D4A3ULL
+#define WY_SECRET3 0x4D5A2DA51DE1AA47ULL
+#define WY_LANE_BYTES 16
+#define WY_BLOCK_BYTES 48
+
+/**
+ * wyhash style byte hash - every 16 bytes are folded by one 64x64->128 bit multiply. strings
+ * longer than 48 bytes run 3 independent lanes, so the multiplies of a block overlap in the
+ * pipeline. all output bits are well mixed, HashMap takes its bucket from the low ones and its
+ * tag from the high ones
+ */
+class StringHash
+{
+private:
+    /**
+     * full 64x64->128 bit multiply, one instruction where the compiler has a 128 bit type
+     * @param a
+     * @param b
+     * @param lo low half of a * b
+     * @param hi high half of a * b
+     */
+    static void _multiply(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi)
+    {
+#ifdef __SIZEOF_INT128__
+        __extension__ typedef unsigned __int128 uint128; //not iso c++, __extension__ keeps -Wpedantic quiet
+        uint128 r = (uint128) a * b;
+        lo = (uint64_t) r;
+        hi = (uint64_t) (r >> 64);
+#else
+        //schoolbook on 32 bit halves
+        uint64_t aLo = (uint32_t) a, aHi = a >> 32, bLo = (uint32_t) b, bHi = b >> 32;
+        uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+        uint64_t mid = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+        lo = (mid << 32) | (uint32_t) ll;
+        hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+    }
+
+    /**
+     *
+     * @param a
+     * @param b
+     * @return low and high halves of a * b, xored
+     */
+    static uint64_t _mix(uint64_t a, uint64_t b)
+    {
+        uint64_t lo, hi;
+        _multiply(a, b, lo, hi);
+        return lo ^ hi;
+    }
+
+    static uint64_t _read8(const unsigned char* p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint64_t _read4(const unsigned char* p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /**
+     *
+     * @param p
+     * @param k 1 to 3
+     * @return first, middle and last byte
+     */
+    static uint64_t _read3(const unsigned char* p, size_t k)
+    { return ((uint64_t) p[0] << 16) | ((uint64_t) p[k >> 1] << 8) | p[k - 1]; }
+
+public:
+    /**
+     *
+     * @param data
+     * @param len
+     * @param seed
+     * @return 64 bit hash of bytes
+     */
+    static uint64_t hash(const void* data, size_t len, uint64_t seed = 0)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        seed ^= _mix(seed ^ WY_SECRET0, WY_SECRET1);
+        uint64_t a, b;
+        if (len <= WY_LANE_BYTES)
+        {
+            if (len >= 4)
+            {
+                size_t mid = (len >> 3) << 2;
+                a = (_read4(p) << 32) | _read4(p + mid);
+                b = (_read4(p + len - 4) << 32) | _read4(p + len - 4 - mid);
+            }
+            else
+            {
+                a = len > 0 ? _read3(p, len) : 0;
+                b = 0;
+            }
+        }
+        else
+        {
+            size_t left = len;
+            if (left > WY_BLOCK_BYTES)
+            {
+                uint64_t lane1 = seed, lane2 = seed;
+                do
+                {
+                    seed = _mix(_read8(p) ^ WY_SECRET1, _read8(p + 8) ^ seed);
+                    lane1 = _mix(_read8(p + 16) ^ WY_SECRET2, _read8(p + 24) ^ lane1);
+                    lane2 = _mix(_read8(p + 32) ^ WY_SECRET3, _read8(p + 40) ^ lane2);
+                    p += WY_BLOCK_BYTES;
+                    left -= WY_BLOCK_BYTES;
+                } while (left > WY_BLOCK_BYTES);
+                seed ^= lane1 ^ lane2;
+            }
+            while (left > WY_LANE_BYTES)
+            {
+                seed = _mix(_read8(p) ^ WY_SECRET1, _read8(p + 8) ^ seed);
+                p += WY_LANE_BYTES;
+                left -= WY_LANE_BYTES;
+            }
+            //last 16 bytes of the string, may overlap the lanes
+            a = _read8(p + left - 16);
+            b = _read8(p + left - 8);
+        }
+        a ^= WY_SECRET1;
+        b ^= seed;
+        uint64_t lo, hi;
+        _multiply(a, b, lo, hi);
+        return _mix(lo ^ WY_SECRET0 ^ len, hi ^ WY_SECRET1);
+    }
+
+    /**
+     * hash of a single 64 bit word, for integral keys - one multiply, with its high half folded
+     * into the low one so every output bit depends on every input bit
+     * @param x
+     * @return 64 bit hash of x
+     */
+    static uint64_t hashWord(uint64_t x)
+    { return _mix(x ^ WY_SECRET0, WY_SECRET1); }
+
+    using is_transparent = void;
+
+    /**
+     * std::string and const char* convert to std::string_view, so all three hash the same
+     * @param s
+     * @return hash of s
+     */
+    size_t operator()(std::string_view s) const
+    { return hash(s.data(), s.size()); }
+};
+
+#endif //EX3_STRINGHASH_HPP
@@ -0,0 +1,258 @@
+#include "TokenDictionary.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define TOKEN_BLOCK 16
+#endif
+
+/**
+ *
+ * @param c
+ * @return true if c is part of a token - ascii letter, digit, or any non ascii byte
+ */
+static bool isTokenByte(unsigned char c)
+{ return c >= 0x80 || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'); }
+
+/**
+ * appends a run of token bytes to the normalized text
+ * @param data normalized text
+ * @param out its length, advanced
+ * @param src lowercased run, may be data itself at or after out
+ * @param n
+ * @param inToken if the run continues the last token, updated
+ * @param starts
+ */
+static void appendRun(char* data, size_t& out, const char* src, size_t n, bool& inToken, std::vector<size_t>& starts)
+{
+    if (!inToken)
+    {
+        if (out > 0)
+        {
+            data[out++] = TOKEN_SEP;
+        }
+        starts.push_back(out);
+        inToken = true;
+    }
+    std::memmove(data + out, src, n);
+    out += n;
+}
+
+size_t TokenDictionary::normalize(char* data, size_t len, std::vector<size_t>& starts)
+{
+    //every token is preceded by at least one delimiter byte before it gets its separator, so the
+    //write position never passes the read position
+    size_t out = 0, i = 0;
+    bool inToken = false;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128(), caseBit = _mm_set1_epi8(0x20);
+    for (; i + TOKEN_BLOCK <= len; i += TOKEN_BLOCK)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        //signed compares - bytes >= 0x80 are negative, and fall outside every ascii range
+        __m128i folded = _mm_or_si128(v, caseBit);
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                       _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i token = _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmplt_epi8(v, zero));
+        unsigned bits = (unsigned) _mm_movemask_epi8(token);
+        if (bits == 0)
+        {
+            inToken = false;
+            continue;
+        }
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        v = _mm_add_epi8(v, _mm_and_si128(upper, caseBit));
+        alignas(TOKEN_BLOCK) char lower[TOKEN_BLOCK];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lower), v);
+
+        //copy each run of token bytes of the block
+        unsigned j = 0;
+        while (j < TOKEN_BLOCK)
+        {
+            unsigned rest = bits >> j;
+            if (rest == 0)
+            {
+                inToken = false;
+                break;
+            }
+            unsigned s = j + __builtin_ctz(rest);
+            if (s > j)
+            {
+                inToken = false;
+            }
+            unsigned e = s + __builtin_ctz(~(bits >> s));
+            appendRun(data, out, lower + s, e - s, inToken, starts);
+            if (e < TOKEN_BLOCK)
+            {
+                inToken = false;
+            }
+            j = e;
+        }
+    }
+#endif
+    for (; i < len; ++i)
+    {
+        unsigned char c = data[i];
+        if (!isTokenByte(c))
+        {
+            inToken = false;
+            continue;
+        }
+        char lower = (char) ((c >= 'A' && c <= 'Z') ? c | 0x20 : c);
+        appendRun(data, out, &lower, 1, inToken, starts);
+    }
+    starts.push_back(out + 1);
+    return out;
+}
+
+TokenDictionary::TokenDictionary(const std::vector<std::string>& phrases, const std::vector<int>& points) :
+    _window(0), _longest(0)
+{
+    if (phrases.size() != points.size())
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //phrases meet their duplicates in a growable map, the static one is built once from the result
+    HashMap<std::string, int> ids;
+    std::vector<std::string> keys;
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < phrases.size(); ++i)
+    {
+        std::string key(phrases[i]);
+        starts.clear();
+        key.resize(normalize(&key[0], key.size(), starts));
+        size_t tokens = starts.size() - 1;
+        if (tokens == 0 || tokens > TOKEN_MAX_NGRAM)
+        {
+            continue;
+        }
+
+        int* id = ids.get(key);
+        if (id != nullptr)
+        {
+            _points[*id] = std::max(_points[*id], points[i]);
+            continue;
+        }
+        _window = std::max(_window, tokens);
+        _longest = std::max(_longest, key.size());
+        ids.try_emplace(key, (int) _points.size());
+        keys.push_back(std::move(key));
+        _points.push_back(points[i]);
+    }
+    std::vector<int> index(keys.size());
+    for (size_t i = 0; i < index.size(); ++i)
+    {
+        index[i] = (int) i;
+    }
+    _ids = StaticHashMap<std::string, int>(keys, index);
+}
+
+void TokenDictionary::Scanner::reset()
+{
+    _score = 0;
+    _carry.clear();
+    _carried = 0;
+    _open = false;
+    if (++_generation == 0)
+    {
+        //stamps wrapped around, old marks could look current
+        std::fill(_seen.begin(), _seen.end(), 0);
+        _generation = 1;
+    }
+}
+
+bool TokenDictionary::Scanner::_probe(const char* text, size_t from, size_t to, int threshold)
+{
+    for (size_t end = from; end < to; ++end)
+    {
+        size_t window = std::min(_dict->_window, end + 1);
+        for (size_t n = 1; n <= window; ++n)
+        {
+            size_t first = end + 1 - n;
+            std::string_view gram(text + _starts[first], _starts[end + 1] - 1 - _starts[first]);
+            const int* id = _dict->_ids.get(gram);
+            if (id != nullptr && _seen[*id] != _generation)
+            {
+                _seen[*id] = _generation;
+                _score += _dict->_points[*id];
+                if (_score >= threshold)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool TokenDictionary::Scanner::scan(char* data, size_t len, int threshold)
+{
+    prepare(data, len);
+    return probe(data, threshold);
+}
+
+size_t TokenDictionary::Scanner::prepare(char* data, size_t len)
+{
+    reset();
+    _starts.clear();
+    return normalize(data, len, _starts);
+}
+
+bool TokenDictionary::Scanner::probe(const char* data, int threshold)
+{ return _probe(data, 0, _starts.size() - 1, threshold); }
+
+bool TokenDictionary::Scanner::feed(const char* data, size_t len, int threshold)
+{
+    if (len == 0)
+    {
+        return false;
+    }
+
+    //a separator keeps a complete carried token apart from the piece, normalizing drops it if the
+    //piece starts with a delimiter anyway
+    if (!_open)
+    {
+        _carry.push_back(TOKEN_SEP);
+    }
+    _carry.append(data, len);
+    _starts.clear();
+    _carry.resize(normalize(&_carry[0], _carry.size(), _starts));
+    _open = isTokenByte(data[len - 1]);
+
+    size_t tokens = _starts.size() - 1;
+    size_t complete = _open ? tokens - 1 : tokens;
+    if (_probe(_carry.data(), _carried, complete, threshold))
+    {
+        return true;
+    }
+
+    //keep what later n-grams can still start with
+    size_t keep = complete - std::min(complete, _dict->_window > 0 ? _dict->_window - 1 : 0);
+    _carry.erase(0, std::min(_starts[keep], _carry.size()));
+    _carried = complete - keep;
+    if (_open)
+    {
+        //an open token longer than every phrase can only grow, it is cut to stay unmatched
+        size_t open = _starts[tokens - 1] - _starts[keep];
+        _carry.resize(std::min(_carry.size(), open + _dict->_longest + 1));
+    }
+    return false;
+}
+
+bool TokenDictionary::Scanner::finish(int threshold)
+{
+    _starts.clear();
+    _carry.resize(normalize(&_carry[0], _carry.size(), _starts));
+    bool spam = _probe(_carry.data(), _carried, _starts.size() - 1, threshold);
+    _carry.clear();
+    _carried = 0;
+    _open = false;
+    return spam;
+}
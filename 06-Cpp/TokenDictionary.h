@@ -0,0 +1,157 @@
+#ifndef EX3_TOKENDICTIONARY_H
+#define EX3_TOKENDICTIONARY_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "StaticHashMap.hpp"
+
+#define TOKEN_MAX_NGRAM 8
+#define TOKEN_SEP ' '
+
+/**
+ * whole word dictionary. phrases and messages are normalized the same way - maximal runs of ascii
+ * letters, digits and non ascii bytes are tokens, lowercased, and anything else only separates
+ * them - and a phrase matches where its tokens appear in a row in the message. every n-gram of
+ * the message up to the longest phrase is probed in a static hash map of the normalized phrases,
+ * one slot read per probe, so a message costs O(tokens * window) whatever the dictionary size.
+ * phrases of more than TOKEN_MAX_NGRAM tokens are not added.
+ */
+class TokenDictionary
+{
+private:
+    StaticHashMap<std::string, int> _ids; //normalized phrase -> index in _points
+    std::vector<int> _points;
+    size_t _window; //tokens of longest phrase
+    size_t _longest; //bytes of longest phrase
+
+public:
+    /**
+     * per message scan state, counts every phrase at most once. a message is either scanned whole,
+     * in place, or fed in pieces - then the last window - 1 tokens of a piece, and the token it
+     * ends in the middle of, are carried into the next one
+     */
+    class Scanner
+    {
+    private:
+        const TokenDictionary* _dict;
+        int _score;
+        uint32_t _generation;
+        std::vector<uint32_t> _seen; //generation in which a phrase was last counted
+        std::vector<size_t> _starts; //token offsets of the current text
+        std::string _carry; //normalized tail of the pieces fed so far
+        size_t _carried; //complete tokens in _carry, their n-grams were probed already
+        bool _open; //last piece ended inside a token
+
+        /**
+         * probes every n-gram of the current text which ends at a token of a range
+         * @param text normalized
+         * @param from first token
+         * @param to past last token
+         * @param threshold
+         * @return true if score reached threshold
+         */
+        bool _probe(const char* text, size_t from, size_t to, int threshold);
+
+    public:
+        /**
+         * ctor
+         * @param dict
+         */
+        explicit Scanner(const TokenDictionary& dict) : _dict(&dict), _score(0), _generation(1),
+                                                        _seen(dict._points.size(), 0), _carried(0), _open(false)
+        {};
+
+        /**
+         * starts a new message, in O(1)
+         */
+        void reset();
+
+        /**
+         * scores a whole message
+         * @param data message, normalized in place
+         * @param len
+         * @param threshold stop once score reaches it
+         * @return true if score reached threshold
+         */
+        bool scan(char* data, size_t len, int threshold);
+
+        /**
+         * starts a whole message by normalizing it, so it can be looked at normalized before it is
+         * scored by probe
+         * @param data message, normalized in place
+         * @param len
+         * @return length of normalized message
+         */
+        size_t prepare(char* data, size_t len);
+
+        /**
+         * scores the message last prepared
+         * @param data as prepare left it
+         * @param threshold stop once score reaches it
+         * @return true if score reached threshold
+         */
+        bool probe(const char* data, int threshold);
+
+        /**
+         * scans more of the message. memory kept between pieces is bounded by the piece size and
+         * the dictionary, not by the message
+         * @param data any bytes
+         * @param len
+         * @param threshold stop once score reaches it
+         * @return true if score reached threshold
+         */
+        bool feed(const char* data, size_t len, int threshold);
+
+        /**
+         * ends a message fed in pieces, scoring the token it ended in
+         * @param threshold
+         * @return true if score reached threshold
+         */
+        bool finish(int threshold);
+
+        /**
+         *
+         * @return sum of points of distinct phrases seen so far
+         */
+        int score() const
+        { return _score; }
+    };
+
+    /**
+     * ctor, normalizes and indexes the phrases. phrases normalizing to the same tokens are one
+     * phrase, worth the most points given to any of them. phrases with no tokens, or more than
+     * TOKEN_MAX_NGRAM, are left out. throws exception if sizes differ
+     * @param phrases
+     * @param points
+     */
+    TokenDictionary(const std::vector<std::string>& phrases, const std::vector<int>& points);
+
+    /**
+     *
+     * @return num of distinct phrases
+     */
+    size_t phrases() const
+    { return _points.size(); }
+
+    /**
+     *
+     * @return tokens of longest phrase
+     */
+    size_t window() const
+    { return _window; }
+
+    /**
+     * normalizes text in place - tokens are lowercased and moved to the front, one TOKEN_SEP
+     * between every two
+     * @param data
+     * @param len
+     * @param starts gets the offset of every token, and one past the end of the text + 1, so token
+     *        i spans [starts[i], starts[i + 1] - 1)
+     * @return length of normalized text
+     */
+    static size_t normalize(char* data, size_t len, std::vector<size_t>& starts);
+};
+
+#endif //EX3_TOKENDICTIONARY_H
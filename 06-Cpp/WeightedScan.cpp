@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include "WeightedScan.h"
+#include "AsciiCase.h"
+
+WeightedScan::WeightedScan(const std::vector<std::string>& phrases, const std::vector<int>& points) : _overlap(0)
+{
+    if (phrases.size() != points.size())
+    {
+        throw std::invalid_argument("exiting ctor due to illegal params\n");
+    }
+
+    //heaviest first, ties by phrase so the order does not depend on where phrases came from
+    std::vector<size_t> order(phrases.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&phrases, &points](size_t a, size_t b)
+    { return points[a] != points[b] ? points[a] > points[b] : phrases[a] < phrases[b]; });
+
+    _phrases.reserve(order.size());
+    _points.reserve(order.size());
+    for (size_t i : order)
+    {
+        _phrases.push_back(phrases[i]);
+        _points.push_back(points[i]);
+        _overlap = std::max(_overlap, phrases[i].empty() ? 0 : phrases[i].size() - 1);
+    }
+    _remaining.assign(order.size() + 1, 0);
+    for (size_t i = order.size(); i > 0; --i)
+    {
+        _remaining[i - 1] = _remaining[i] + _points[i - 1];
+    }
+}
+
+bool WeightedScan::Scanner::scan(char* data, size_t len, int threshold)
+{
+    _score = 0;
+    _evaluated = 0;
+    AsciiCase::toLower(data, len);
+    std::string_view msg(data, len);
+
+    for (size_t i = 0; i < _dict->_phrases.size(); ++i)
+    {
+        if (_score >= threshold)
+        {
+            return true;
+        }
+        if (_score + _dict->_remaining[i] < threshold)
+        {
+            //clean whatever the rest holds
+            return false;
+        }
+        ++_evaluated;
+        if (msg.find(_dict->_phrases[i]) != std::string_view::npos)
+        {
+            _score += _dict->_points[i];
+        }
+    }
+    return _score >= threshold;
+}
+
+void WeightedScan::Scanner::reset()
+{
+    _score = 0;
+    _evaluated = 0;
+    std::fill(_found.begin(), _found.end(), 0);
+    _window.clear();
+}
+
+bool WeightedScan::Scanner::feed(const char* data, size_t len, int threshold)
+{
+    if (_score >= threshold)
+    {
+        return true;
+    }
+    size_t start = _window.size();
+    _window.append(data, len);
+    AsciiCase::toLower(&_window[start], len);
+    std::string_view msg(_window);
+
+    //the rest of the message is unseen, so no phrase can be ruled out before the last piece. every
+    //phrase searched at least once is a prefix of the order, evaluated counts it as a whole scan does
+    for (size_t i = 0; i < _dict->_phrases.size() && _score < threshold; ++i)
+    {
+        if (_found[i])
+        {
+            continue;
+        }
+        _evaluated = std::max(_evaluated, i + 1);
+        if (msg.find(_dict->_phrases[i]) != std::string_view::npos)
+        {
+            _found[i] = 1;
+            _score += _dict->_points[i];
+        }
+    }
+    _window.erase(0, _window.size() - std::min(_window.size(), _dict->_overlap));
+    return _score >= threshold;
+}
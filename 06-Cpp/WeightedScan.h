@@ -0,0 +1,100 @@
+#ifndef EX3_WEIGHTEDSCAN_H
+#define EX3_WEIGHTEDSCAN_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+ * bad words sorted by descending points, searched in a message one by one. the points of the
+ * phrases not searched yet bound the score the message can still reach, so the scan stops as soon
+ * as the verdict is known either way - at the threshold, or once even all remaining phrases could
+ * not reach it. heavy phrases decide most messages after a few searches. a message too long to
+ * hold can be fed in pieces instead, each searched with the tail of the one before it
+ */
+class WeightedScan
+{
+private:
+    std::vector<std::string> _phrases;
+    std::vector<int> _points;
+    std::vector<long long> _remaining; //points of phrases i and on, one entry past the last
+    size_t _overlap; //longest phrase - 1, the tail of a piece kept for the next one
+
+public:
+    /**
+     * per message scan state
+     */
+    class Scanner
+    {
+    private:
+        const WeightedScan* _dict;
+        int _score;
+        size_t _evaluated;
+        std::vector<char> _found; //per phrase, in a message fed in pieces
+        std::string _window; //tail of the last piece, then the next piece
+
+    public:
+        /**
+         * ctor
+         * @param dict
+         */
+        explicit Scanner(const WeightedScan& dict) : _dict(&dict), _score(0), _evaluated(0),
+                                                     _found(dict._phrases.size(), 0)
+        {};
+
+        /**
+         * scores a whole message
+         * @param data message, lowercased in place
+         * @param len
+         * @param threshold
+         * @return true if score reached threshold
+         */
+        bool scan(char* data, size_t len, int threshold);
+
+        /**
+         * starts a new message fed in pieces
+         */
+        void reset();
+
+        /**
+         * scans more of the message. every phrase not found yet is searched in the piece, led by
+         * the last longest phrase - 1 bytes of the one before, so phrases across the edge match.
+         * memory kept between pieces is bounded by the piece size and the longest phrase
+         * @param data any bytes, ascii case is ignored
+         * @param len
+         * @param threshold stop once score reaches it
+         * @return true if score reached threshold
+         */
+        bool feed(const char* data, size_t len, int threshold);
+
+        /**
+         *
+         * @return sum of points of phrases found until the verdict
+         */
+        int score() const
+        { return _score; }
+
+        /**
+         *
+         * @return num of phrases searched until the verdict
+         */
+        size_t evaluated() const
+        { return _evaluated; }
+    };
+
+    /**
+     * ctor, sorts the phrases. throws exception if sizes differ
+     * @param phrases lowercased, non empty, distinct
+     * @param points points of each phrase, not negative
+     */
+    WeightedScan(const std::vector<std::string>& phrases, const std::vector<int>& points);
+
+    /**
+     *
+     * @return num of phrases
+     */
+    size_t phrases() const
+    { return _phrases.size(); }
+};
+
+#endif //EX3_WEIGHTEDSCAN_H
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdlib>
+#include "WorkerPool.h"
+
+/**
+ * ctor
+ * @param threads
+ */
+WorkerPool::WorkerPool(size_t threads) : _busy(0), _stop(false), _failed(false)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        _threads.emplace_back(&WorkerPool::_work, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stop = true;
+    }
+    _ready.notify_all();
+    for (std::thread& t : _threads)
+    {
+        t.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _tasks.push_back(std::move(task));
+    }
+    _ready.notify_one();
+}
+
+int WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+    _idle.wait(guard, [this] { return _tasks.empty() && _busy == 0; });
+    bool failed = _failed;
+    _failed = false;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+void WorkerPool::_work()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true)
+    {
+        _ready.wait(guard, [this] { return _stop || !_tasks.empty(); });
+        if (_tasks.empty())
+        {
+            return; //stopped, and nothing left to run
+        }
+
+        std::function<void()> task = std::move(_tasks.front());
+        _tasks.pop_front();
+        ++_busy;
+        guard.unlock();
+        bool failed = false;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            //an exception leaving a thread would terminate the process
+            failed = true;
+        }
+        guard.lock();
+        _failed = _failed || failed;
+        --_busy;
+        if (_tasks.empty() && _busy == 0)
+        {
+            _idle.notify_all();
+        }
+    }
+}
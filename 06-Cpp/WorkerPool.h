@@ -0,0 +1,67 @@
+#ifndef EX3_WORKERPOOL_H
+#define EX3_WORKERPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * fixed size thread pool running submitted tasks in fifo order. a task that throws is abandoned,
+ * the pool keeps running and the next wait() reports it
+ */
+class WorkerPool
+{
+private:
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _lock;
+    std::condition_variable _ready, _idle;
+    size_t _busy;
+    bool _stop;
+    bool _failed; //a task threw since the last wait
+
+    /**
+     * worker loop, runs tasks until the pool stops
+     */
+    void _work();
+
+public:
+    /**
+     * ctor, starts the threads
+     * @param threads num of workers, 0 for one per core
+     */
+    explicit WorkerPool(size_t threads = 0);
+
+    WorkerPool(const WorkerPool& other) = delete;
+
+    WorkerPool& operator=(const WorkerPool& other) = delete;
+
+    /**
+     * dtor, runs the tasks still queued and joins the threads
+     */
+    ~WorkerPool();
+
+    /**
+     * queues a task
+     * @param task
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * blocks until every submitted task is done
+     * @return EXIT_FAILURE if a task threw since the last wait, EXIT_SUCCESS otherwise
+     */
+    int wait();
+
+    /**
+     *
+     * @return num of workers
+     */
+    size_t size() const
+    { return _threads.size(); }
+};
+
+#endif //EX3_WORKERPOOL_H
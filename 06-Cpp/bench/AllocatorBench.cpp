@@ -0,0 +1,133 @@
+/**
+ * HashMap table storage from std::allocator, an Arena and a Pool, on every layout. one big map is
+ * filled, read, emptied and destroyed, then many small maps are built and thrown away, where the
+ * heap is hit hardest. key strings allocate on their own either way, keys are kept short so
+ * their bytes stay inline.
+ * build: g++ -std=c++17 -O2 -I.. AllocatorBench.cpp -o allocator_bench
+ * usage: allocator_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "HashMap.hpp"
+#include "Allocators.hpp"
+#include "BenchUtil.hpp"
+
+#define SMALL_MAP_KEYS 64
+#define SMALL_MAP_ROUNDS 20
+#define SHORT_KEY 15
+
+using pair = std::pair<std::string, int>;
+
+/**
+ * times one big map and many small ones, all with storage from alloc, and prints the times
+ * @tparam Layout
+ * @tparam Alloc
+ * @param name
+ * @param keys
+ * @param alloc
+ * @param release called after the big map and after every round of small maps, frees what they left
+ * @param blockBytes reports bytes the allocator holds in blocks of its own, 0 if it has none
+ */
+template<typename Layout, typename Alloc, typename Release, typename Bytes>
+void measure(const char* name, const std::vector<std::string>& keys, const Alloc& alloc, Release&& release,
+             Bytes&& blockBytes)
+{
+    using Map = HashMap<std::string, int, Layout, KeyHash<std::string>, std::equal_to<>, Alloc>;
+    double fill, read, erase, destroy;
+    long sum = 0;
+    size_t bytes;
+    {
+        Map* map = new Map(alloc);
+        BenchTimer timer;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            map->try_emplace(keys[i], (int) i);
+        }
+        fill = timer.seconds();
+        timer.restart();
+        for (const std::string& k : keys)
+        {
+            sum += *map->get(k);
+        }
+        read = timer.seconds();
+        bytes = blockBytes();
+        timer.restart();
+        for (size_t i = 0; i < keys.size(); i += 2)
+        {
+            map->erase(keys[i]);
+        }
+        erase = timer.seconds();
+        timer.restart();
+        delete map;
+        release();
+        destroy = timer.seconds();
+    }
+
+    BenchTimer timer;
+    for (int r = 0; r < SMALL_MAP_ROUNDS; ++r)
+    {
+        for (size_t first = 0; first + SMALL_MAP_KEYS <= keys.size(); first += SMALL_MAP_KEYS)
+        {
+            Map map(alloc);
+            for (size_t i = first; i < first + SMALL_MAP_KEYS; ++i)
+            {
+                map.try_emplace(keys[i], (int) i);
+            }
+            sum += map.size();
+        }
+        release();
+    }
+    double small = timer.seconds();
+    benchKeep(sum);
+    double maps = (double) keys.size() / SMALL_MAP_KEYS * SMALL_MAP_ROUNDS;
+    std::cout << name << ": fill " << fill * 1e9 / keys.size() << " ns, read " << read * 1e9 / keys.size()
+              << " ns, erase " << erase * 2e9 / keys.size() << " ns per key, destroy " << destroy * 1e3
+              << " ms, small map " << small * 1e9 / maps << " ns";
+    if (bytes > 0)
+    {
+        std::cout << ", " << bytes / 1024 << " KiB in blocks";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * one layout with every allocator
+ * @tparam Layout
+ * @param name
+ * @param keys
+ */
+template<typename Layout>
+void measureLayout(const std::string& name, const std::vector<std::string>& keys)
+{
+    auto none = [] {};
+    measure<Layout>((name + " std::allocator").c_str(), keys, std::allocator<pair>(), none, []
+    { return (size_t) 0; });
+
+    Arena arena;
+    measure<Layout>((name + " arena").c_str(), keys, ArenaAllocator<pair>(arena), [&arena]
+    { arena.release(); }, [&arena]
+    { return arena.bytes(); });
+
+    //freed blocks go back to the pool's free lists, nothing to release between maps
+    Pool pool;
+    measure<Layout>((name + " pool").c_str(), keys, PoolAllocator<pair>(pool), none, [&pool]
+    { return pool.bytes(); });
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    for (std::string& k : keys)
+    {
+        k.resize(std::min(k.size(), (size_t) SHORT_KEY));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(BENCH_SEED));
+    std::cout << keys.size() << " keys\n";
+    measureLayout<FlatLayout>("flat", keys);
+    measureLayout<ChainedLayout>("chained", keys);
+    measureLayout<DenseLayout>("dense", keys);
+    return EXIT_SUCCESS;
+}
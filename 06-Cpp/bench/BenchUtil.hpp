@@ -0,0 +1,105 @@
+#ifndef EX3_BENCHUTIL_HPP
+#define EX3_BENCHUTIL_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#define BENCH_KEYS_I 200000
+#define BENCH_SEED 42
+#define BENCH_DELIM ','
+
+/**
+ * keys to benchmark on - the bad strings of a CSV database if a path is given (first arg),
+ * otherwise n lowercase phrases of 1 to 4 random words
+ * @param argc
+ * @param argv
+ * @param n
+ * @return keys, duplicates removed
+ */
+inline std::vector<std::string> benchKeys(int argc, char* argv[], size_t n = BENCH_KEYS_I)
+{
+    std::vector<std::string> out;
+    if (argc > 1)
+    {
+        std::ifstream db(argv[1]);
+        std::string line;
+        while (std::getline(db, line))
+        {
+            std::string key = line.substr(0, line.rfind(BENCH_DELIM));
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c)
+            { return (char) ((c >= 'A' && c <= 'Z') ? c | 0x20 : c); });
+            out.push_back(std::move(key));
+        }
+    }
+    else
+    {
+        std::mt19937_64 rng(BENCH_SEED);
+        out.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::string key;
+            for (size_t w = 0, words = 1 + rng() % 4; w < words; ++w)
+            {
+                key += w > 0 ? " " : "";
+                for (size_t c = 0, len = 3 + rng() % 8; c < len; ++c)
+                {
+                    key += (char) ('a' + rng() % 26);
+                }
+            }
+            out.push_back(std::move(key));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    std::shuffle(out.begin(), out.end(), std::mt19937_64(BENCH_SEED));
+    return out;
+}
+
+/**
+ * wall clock timer, started on construction
+ */
+class BenchTimer
+{
+private:
+    std::chrono::steady_clock::time_point _start;
+
+public:
+    BenchTimer() : _start(std::chrono::steady_clock::now())
+    {}
+
+    /**
+     *
+     * @return seconds since construction or last restart()
+     */
+    double seconds() const
+    { return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count(); }
+
+    /**
+     * starts over
+     */
+    void restart()
+    { _start = std::chrono::steady_clock::now(); }
+};
+
+/**
+ *
+ * @param sorted samples in ascending order
+ * @param p percent, 0 to 100
+ * @return p-th percentile of samples
+ */
+inline double benchPercentile(const std::vector<double>& sorted, double p)
+{ return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, (size_t) (p / 100 * sorted.size()))]; }
+
+/**
+ * keeps the compiler from dropping a computed value
+ * @param v
+ */
+template<typename T>
+inline void benchKeep(const T& v)
+{ asm volatile("" : : "g"(&v) : "memory"); }
+
+#endif //EX3_BENCHUTIL_HPP
@@ -0,0 +1,87 @@
+/**
+ * AsciiCase::toLower kernels side by side - avx2, sse2 and the plain loop - on buffers from a few
+ * bytes (a bad word) to a megabyte (a large message), mixed case text with some non ascii bytes.
+ * every kernel must give the same bytes. kernels this cpu lacks are skipped.
+ * build: g++ -std=c++17 -O2 -I.. CaseBench.cpp ../AsciiCase.cpp -o case_bench
+ * usage: case_bench
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "AsciiCase.h"
+#include "BenchUtil.hpp"
+
+#define CASE_TOTAL_BYTES (256 * 1024 * 1024)
+
+/**
+ *
+ * @param len
+ * @return len bytes of random mixed case words, with a non ascii byte here and there
+ */
+std::string mixedText(size_t len)
+{
+    std::mt19937_64 rng(BENCH_SEED);
+    std::string text(len, ' ');
+    for (char& c : text)
+    {
+        unsigned dice = rng() % 100;
+        c = dice < 40 ? (char) ('a' + rng() % 26) : dice < 80 ? (char) ('A' + rng() % 26) :
+            dice < 95 ? ' ' : (char) (0x80 + rng() % 0x80);
+    }
+    return text;
+}
+
+int main()
+{
+    const char* kernels[] = {"avx2", "sse2", "scalar"};
+    std::cout << "picked kernel: " << AsciiCase::kernel() << "\n";
+    int result = EXIT_SUCCESS;
+    for (size_t len : {8, 16, 64, 256, 4096, 65536, 1 << 20})
+    {
+        std::string source = mixedText(len), expected;
+        for (const char* kernel : kernels)
+        {
+            AsciiCase::Lower lower = AsciiCase::kernelNamed(kernel);
+            if (lower == nullptr)
+            {
+                continue;
+            }
+            std::string buf = source;
+            lower(&buf[0], buf.size());
+            if (expected.empty())
+            {
+                expected = buf;
+            }
+            else if (buf != expected)
+            {
+                std::cerr << kernel << " differs at " << len << " bytes\n";
+                result = EXIT_FAILURE;
+            }
+
+            //lowering again finds nothing to change, so the buffer is reset from source every round
+            size_t rounds = CASE_TOTAL_BYTES / len;
+            std::vector<char> work(source.begin(), source.end());
+            BenchTimer timer;
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                std::copy(source.begin(), source.end(), work.begin());
+                lower(work.data(), work.size());
+                benchKeep(work);
+            }
+            double seconds = timer.seconds();
+
+            //the copies alone, to take them out
+            timer.restart();
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                std::copy(source.begin(), source.end(), work.begin());
+                benchKeep(work);
+            }
+            seconds -= timer.seconds();
+            std::cout << kernel << " " << len << " bytes: " << seconds * 1e9 / rounds << " ns, "
+                      << (double) len * rounds / seconds / 1e9 << " GB/s\n";
+        }
+    }
+    return result;
+}
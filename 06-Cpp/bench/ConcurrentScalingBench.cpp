@@ -0,0 +1,148 @@
+/**
+ * thread scaling of ConcurrentHashMap from 1 to 64 threads, against one HashMap behind a global
+ * mutex. a fixed total of operations, mostly lookups with some assigns and erase / insert pairs,
+ * is split among the threads, and the run is also timed while the threads fill the map from empty.
+ * build: g++ -std=c++17 -O2 -pthread -I.. ConcurrentScalingBench.cpp -o scaling_bench
+ * usage: scaling_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <cstdlib>
+#include "ConcurrentHashMap.hpp"
+#include "BenchUtil.hpp"
+
+#define SCALING_OPS 4000000
+#define SCALING_MAX_THREADS 64
+#define SCALING_WRITE_PERCENT 10
+
+/**
+ * one HashMap behind one mutex, the baseline
+ */
+class LockedMap
+{
+private:
+    mutable std::mutex _lock;
+    HashMap<std::string, int> _map;
+
+public:
+    bool insert(const std::string& k, int v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _map.try_emplace(k, v);
+    }
+
+    bool insert_or_assign(const std::string& k, int v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _map.insert_or_assign(k, v);
+    }
+
+    bool erase(const std::string& k)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _map.erase(k);
+    }
+
+    bool tryGet(const std::string& k, int& out) const
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        const int* v = _map.get(k);
+        if (v == nullptr)
+        {
+            return false;
+        }
+        out = *v;
+        return true;
+    }
+};
+
+/**
+ * runs f(thread index, first, last) on threads threads, splitting [0, n) among them
+ * @param threads
+ * @param n
+ * @param f
+ * @return seconds until all threads finished
+ */
+template<typename F>
+double run(int threads, size_t n, F&& f)
+{
+    std::vector<std::thread> workers;
+    BenchTimer timer;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&f, t, threads, n]
+                             { f(t, n * t / threads, n * (t + 1) / threads); });
+    }
+    for (std::thread& w : workers)
+    {
+        w.join();
+    }
+    return timer.seconds();
+}
+
+/**
+ * fills a map from empty on threads threads, then runs the mixed workload, and prints both rates
+ * @tparam Map
+ * @param name
+ * @param keys
+ * @param threads
+ */
+template<typename Map>
+void measure(const char* name, const std::vector<std::string>& keys, int threads)
+{
+    Map map;
+    double fill = run(threads, keys.size(), [&map, &keys](int, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            map.insert(keys[i], (int) i);
+        }
+    });
+
+    std::vector<long> sums(threads);
+    double mixed = run(threads, SCALING_OPS, [&map, &keys, &sums](int t, size_t first, size_t last)
+    {
+        std::mt19937_64 rng(BENCH_SEED + t);
+        long sum = 0;
+        for (size_t i = first; i < last; ++i)
+        {
+            const std::string& k = keys[rng() % keys.size()];
+            unsigned dice = rng() % 100;
+            int v;
+            if (dice < SCALING_WRITE_PERCENT / 2)
+            {
+                map.insert_or_assign(k, (int) i);
+            }
+            else if (dice < SCALING_WRITE_PERCENT)
+            {
+                //erased and put back, so the map keeps its size
+                map.erase(k);
+                map.insert(k, (int) i);
+            }
+            else if (map.tryGet(k, v))
+            {
+                sum += v;
+            }
+        }
+        sums[t] = sum;
+    });
+    benchKeep(sums);
+    std::cout << name << " threads " << threads << ": fill " << keys.size() / fill / 1e6 << " Mops/s, mixed "
+              << SCALING_OPS / mixed / 1e6 << " Mops/s\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::cout << keys.size() << " keys, " << SCALING_OPS << " mixed ops (" << SCALING_WRITE_PERCENT
+              << "% writes), " << std::thread::hardware_concurrency() << " hardware threads\n";
+    for (int threads = 1; threads <= SCALING_MAX_THREADS; threads *= 2)
+    {
+        measure<ConcurrentHashMap<std::string, int>>("concurrent", keys, threads);
+        measure<LockedMap>("global lock", keys, threads);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/**
+ * StringHash against std::hash<std::string_view> on the dictionary keys - hashing speed, how
+ * evenly the low bits (HashMap's bucket) and the top 7 bits (its tag) spread the keys, and
+ * HashMap lookups with each hasher.
+ * build: g++ -std=c++17 -O2 -I.. HashBench.cpp -o hash_bench
+ * usage: hash_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdlib>
+#include "HashMap.hpp"
+#include "BenchUtil.hpp"
+
+#define HASH_ROUNDS 20
+#define HASH_TAGS 128
+
+/**
+ * std::hash, taking every string type through std::string_view like StringHash
+ */
+struct StdHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const
+    { return std::hash<std::string_view>{}(s); }
+};
+
+/**
+ * chi square of counts against an even spread, divided by its degrees of freedom - about 1 for
+ * a random hash, well above it for a skewed one
+ * @param counts
+ * @param n total count
+ * @return normalized chi square
+ */
+double chiSquare(const std::vector<size_t>& counts, size_t n)
+{
+    double expected = (double) n / counts.size(), sum = 0;
+    for (size_t c : counts)
+    {
+        sum += (c - expected) * (c - expected) / expected;
+    }
+    return sum / (counts.size() - 1);
+}
+
+/**
+ * prints speed and spread of a hasher, and lookup times of a HashMap using it
+ * @tparam H
+ * @param name
+ * @param keys
+ * @param missing keys not in the map
+ */
+template<typename H>
+void measure(const char* name, const std::vector<std::string>& keys, const std::vector<std::string>& missing)
+{
+    H h;
+    size_t bytes = 0;
+    for (const std::string& k : keys)
+    {
+        bytes += k.size();
+    }
+    uint64_t sink = 0;
+    BenchTimer timer;
+    for (int r = 0; r < HASH_ROUNDS; ++r)
+    {
+        for (const std::string& k : keys)
+        {
+            sink += h(k);
+        }
+    }
+    double seconds = timer.seconds();
+
+    //the table a HashMap of this many keys would have, at most 3/4 full
+    size_t buckets = CAP_I;
+    while (keys.size() > buckets * UPPER_I)
+    {
+        buckets *= FACTOR;
+    }
+    std::vector<size_t> perBucket(buckets), perTag(HASH_TAGS), hashes;
+    for (const std::string& k : keys)
+    {
+        size_t x = h(k);
+        ++perBucket[x & (buckets - 1)];
+        ++perTag[x >> (sizeof(size_t) * 8 - TAG_BITS)];
+        hashes.push_back(x);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    size_t collisions = hashes.end() - std::unique(hashes.begin(), hashes.end());
+
+    HashMap<std::string, int, FlatLayout, H> map;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        map.try_emplace(keys[i], (int) i);
+    }
+    timer.restart();
+    for (int r = 0; r < HASH_ROUNDS; ++r)
+    {
+        for (const std::string& k : keys)
+        {
+            sink += *map.get(std::string_view(k));
+        }
+    }
+    double hits = timer.seconds();
+    timer.restart();
+    for (int r = 0; r < HASH_ROUNDS; ++r)
+    {
+        for (const std::string& k : missing)
+        {
+            sink += map.get(std::string_view(k)) == nullptr;
+        }
+    }
+    double misses = timer.seconds();
+    benchKeep(sink);
+
+    double calls = (double) keys.size() * HASH_ROUNDS;
+    std::cout << name << ": " << seconds * 1e9 / calls << " ns per key, " << bytes * HASH_ROUNDS / seconds / 1e9
+              << " GB/s, bucket chi2 " << chiSquare(perBucket, keys.size()) << ", tag chi2 "
+              << chiSquare(perTag, keys.size()) << ", " << collisions << " full collisions, get hit "
+              << hits * 1e9 / calls << " ns, get miss " << misses * 1e9 / calls << " ns\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::vector<std::string> missing;
+    size_t bytes = 0;
+    for (const std::string& k : keys)
+    {
+        missing.push_back(k + "#");
+        bytes += k.size();
+    }
+    std::cout << keys.size() << " keys, " << (double) bytes / keys.size() << " bytes on average\n";
+    measure<StringHash>("StringHash", keys, missing);
+    measure<StdHash>("std::hash", keys, missing);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/**
+ * load time of a HashMap from key and value vectors - inserting pair by pair from the default
+ * capacity, which rehashes through every power of 2 on the way, reserving first and then
+ * inserting pair by pair, and the bulk HashMap(keys, values) ctor.
+ * build: g++ -std=c++17 -O2 -I.. LoadBench.cpp -o load_bench
+ * usage: load_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "HashMap.hpp"
+#include "BenchUtil.hpp"
+
+#define LOAD_KEYS 2000000
+#define LOAD_ROUNDS 3
+
+/**
+ * builds a map rounds times with build, and prints the best time
+ * @tparam Map
+ * @tparam Build
+ * @param name
+ * @param keys
+ * @param build callable returning a Map
+ */
+template<typename Map, typename Build>
+void measure(const char* name, const std::vector<std::string>& keys, Build&& build)
+{
+    double best = 0;
+    long sum = 0;
+    for (int r = 0; r < LOAD_ROUNDS; ++r)
+    {
+        BenchTimer timer;
+        Map map = build();
+        double seconds = timer.seconds();
+        best = r == 0 ? seconds : std::min(best, seconds);
+        sum += map.size();
+    }
+    benchKeep(sum);
+    std::cout << name << ": " << best * 1e3 << " ms, " << best * 1e9 / keys.size() << " ns per pair\n";
+}
+
+/**
+ * one layout, all three ways
+ * @tparam Layout
+ * @param name
+ * @param keys
+ * @param values
+ */
+template<typename Layout>
+void measureLayout(const std::string& name, const std::vector<std::string>& keys, const std::vector<int>& values)
+{
+    using Map = HashMap<std::string, int, Layout>;
+    measure<Map>((name + " insert").c_str(), keys, [&keys, &values]
+    {
+        Map map;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            map.insert_or_assign(keys[i], values[i]);
+        }
+        return map;
+    });
+    measure<Map>((name + " reserve + insert").c_str(), keys, [&keys, &values]
+    {
+        Map map;
+        map.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            map.insert_or_assign(keys[i], values[i]);
+        }
+        return map;
+    });
+    measure<Map>((name + " bulk ctor").c_str(), keys, [&keys, &values]
+    { return Map(keys, values); });
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv, LOAD_KEYS);
+    std::vector<int> values(keys.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = (int) i;
+    }
+    std::cout << keys.size() << " pairs\n";
+    measureLayout<FlatLayout>("flat", keys, values);
+    measureLayout<ChainedLayout>("chained", keys, values);
+    measureLayout<DenseLayout>("dense", keys, values);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/**
+ * lookup cost of HashMap - hashes, heap allocations and time per operation, for every public
+ * lookup and for insert / erase. every operation should hash its key once, and allocate nothing
+ * but an occasional table resize.
+ * build: g++ -std=c++17 -O2 -I.. LookupBench.cpp -o lookup_bench
+ * usage: lookup_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <new>
+#include "HashMap.hpp"
+#include "BenchUtil.hpp"
+
+#define LOOKUP_ROUNDS 5
+
+static size_t allocations = 0;
+
+void* operator new(size_t n)
+{
+    ++allocations;
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{ std::free(p); }
+
+void operator delete(void* p, size_t n) noexcept
+{
+    (void) n;
+    std::free(p);
+}
+
+/**
+ * StringHash, counting its calls
+ */
+struct CountingHash : StringHash
+{
+    inline static size_t calls = 0;
+
+    size_t operator()(std::string_view s) const
+    {
+        ++calls;
+        return StringHash::operator()(s);
+    }
+};
+
+using Map = HashMap<std::string, int, FlatLayout, CountingHash>;
+
+/**
+ * runs op once per key, rounds times, and prints its cost per call
+ * @param name
+ * @param keys
+ * @param rounds
+ * @param op callable with const std::string&, returns a value to keep
+ */
+template<typename Op>
+void measure(const char* name, const std::vector<std::string>& keys, int rounds, Op&& op)
+{
+    size_t hashes = CountingHash::calls, allocs = allocations;
+    BenchTimer timer;
+    long sink = 0;
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (const std::string& k : keys)
+        {
+            sink += op(k);
+        }
+    }
+    double seconds = timer.seconds();
+    benchKeep(sink);
+    double calls = (double) keys.size() * rounds;
+    std::cout << name << ": " << seconds * 1e9 / calls << " ns, " << (CountingHash::calls - hashes) / calls
+              << " hashes, " << (allocations - allocs) / calls << " allocations per call\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::vector<std::string> missing;
+    for (const std::string& k : keys)
+    {
+        missing.push_back(k + "#");
+    }
+
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        map.try_emplace(keys[i], (int) i);
+    }
+    std::cout << keys.size() << " keys\n";
+
+    measure("get(string) hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return *map.get(k); });
+    measure("get(string_view) hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return *map.get(std::string_view(k)); });
+    measure("get(const char*) hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return *map.get(k.c_str()); });
+    measure("get miss", missing, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return map.get(std::string_view(k)) == nullptr; });
+    measure("containsKey hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return map.containsKey(k); });
+    measure("at hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return map.at(k); });
+    measure("operator[] const hit", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return static_cast<const Map&>(map)[k]; });
+
+    //mutations run one round, so every call finds what it expects. keys to move in are copied
+    //before the timed loop, and resizes (counted in) are the only allocations of the map itself
+    std::vector<std::string> copies(keys);
+    measure("erase hit", keys, 1, [&map](const std::string& k)
+    { return map.erase(std::string_view(k)); });
+    size_t i = 0;
+    measure("try_emplace(string&&) new", keys, 1, [&map, &copies, &i](const std::string& k)
+    {
+        (void) k;
+        return map.try_emplace(std::move(copies[i++]), 0);
+    });
+    measure("try_emplace existing", keys, LOOKUP_ROUNDS, [&map](const std::string& k)
+    { return map.try_emplace(k, 0); });
+    return EXIT_SUCCESS;
+}
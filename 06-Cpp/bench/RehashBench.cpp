@@ -0,0 +1,61 @@
+/**
+ * insert latency of HashMap with stop-the-world and incremental rehash. every insert is timed
+ * alone, a full resize shows up as the max and the high percentiles, incremental rehash spreads it
+ * over the inserts that follow.
+ * build: g++ -std=c++17 -O2 -I.. RehashBench.cpp -o rehash_bench
+ * usage: rehash_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "HashMap.hpp"
+#include "BenchUtil.hpp"
+
+/**
+ * inserts every key, timing each insert, and prints the latency percentiles
+ * @tparam Layout
+ * @param name
+ * @param keys
+ * @param step buckets moved per insert, 0 for stop-the-world rehash
+ */
+template<typename Layout>
+void measure(const char* name, const std::vector<std::string>& keys, size_t step)
+{
+    HashMap<std::string, int, Layout> map;
+    map.setIncrementalRehash(step);
+    std::vector<double> latencies; //nanoseconds
+    latencies.reserve(keys.size());
+    BenchTimer total;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        map.try_emplace(keys[i], (int) i);
+        latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                                .count());
+    }
+    double seconds = total.seconds();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name << " step " << step << ": total " << seconds * 1e3 << " ms, p50 "
+              << benchPercentile(latencies, 50) << " ns, p99 " << benchPercentile(latencies, 99) << " ns, p99.9 "
+              << benchPercentile(latencies, 99.9) << " ns, p99.99 " << benchPercentile(latencies, 99.99)
+              << " ns, max " << latencies.back() << " ns\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::cout << keys.size() << " keys\n";
+    for (size_t step : {0, 1, 4, 16})
+    {
+        measure<FlatLayout>("flat", keys, step);
+    }
+    for (size_t step : {0, 1, 4, 16})
+    {
+        measure<ChainedLayout>("chained", keys, step);
+    }
+    for (size_t step : {0, 1, 4, 16})
+    {
+        measure<DenseLayout>("dense", keys, step);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/**
+ * StaticHashMap against HashMap, with and without its prefilter, as the read-only dictionary -
+ * build time, hash metadata, and get on keys in the map and on keys not in it. the token scorer
+ * mostly misses, so misses count most.
+ * build: g++ -std=c++17 -O2 -I.. StaticMapBench.cpp -o static_map_bench
+ * usage: static_map_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include "StaticHashMap.hpp"
+#include "BenchUtil.hpp"
+
+#define STATIC_ROUNDS 20
+
+/**
+ * times gets of every key of a list, rounds times
+ * @tparam Map
+ * @param map
+ * @param keys
+ * @return ns per get
+ */
+template<typename Map>
+double timeGets(const Map& map, const std::vector<std::string>& keys)
+{
+    long sum = 0;
+    BenchTimer timer;
+    for (int r = 0; r < STATIC_ROUNDS; ++r)
+    {
+        for (const std::string& k : keys)
+        {
+            const int* v = map.get(std::string_view(k));
+            sum += v == nullptr ? 1 : *v;
+        }
+    }
+    double seconds = timer.seconds();
+    benchKeep(sum);
+    return seconds * 1e9 / ((double) keys.size() * STATIC_ROUNDS);
+}
+
+/**
+ * prints build time and get times of a map
+ * @tparam Map
+ * @param name
+ * @param build callable returning a Map
+ * @param keys
+ * @param missing
+ */
+template<typename Map, typename Build>
+void measure(const char* name, Build&& build, const std::vector<std::string>& keys,
+             const std::vector<std::string>& missing)
+{
+    BenchTimer timer;
+    Map map = build();
+    double seconds = timer.seconds();
+    std::cout << name << ": build " << seconds * 1e3 << " ms, get hit " << timeGets(map, keys) << " ns, get miss "
+              << timeGets(map, missing) << " ns\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::vector<std::string> missing;
+    std::vector<int> values;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        missing.push_back(keys[i] + "#");
+        values.push_back((int) i);
+    }
+    std::cout << keys.size() << " keys\n";
+
+    using Static = StaticHashMap<std::string, int>;
+    using Dynamic = HashMap<std::string, int>;
+    measure<Static>("static", [&keys, &values]
+    { return Static(keys, values); }, keys, missing);
+    std::cout << "static metadata: " << Static(keys, values).bitsPerKey() << " bits per key\n";
+    measure<Dynamic>("hashmap", [&keys, &values]
+    { return Dynamic(keys, values); }, keys, missing);
+    measure<Dynamic>("hashmap + prefilter", [&keys, &values]
+    {
+        Dynamic map(keys, values);
+        map.setPrefilter(true);
+        return map;
+    }, keys, missing);
+    return EXIT_SUCCESS;
+}
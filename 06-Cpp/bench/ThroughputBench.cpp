@@ -0,0 +1,160 @@
+/**
+ * batch scoring throughput, in msg/s and msg/s/core, of every scoring mode on 1 thread up to one
+ * per core. messages are scored on a WorkerPool the way the batch subcommand does it - a scanner
+ * per worker, pulling the next unscored message. substrings and tokens modes get a threshold no
+ * message reaches, so every message is scanned to its end. scan mode stops once the threshold is out
+ * of reach, so it gets a reachable one, and searching the dictionary phrase by phrase is slow enough
+ * to time it on a share of the messages only.
+ * build: g++ -std=c++17 -O2 -pthread -I.. ThroughputBench.cpp ../AhoCorasick.cpp ../TokenDictionary.cpp
+ *        ../WeightedScan.cpp ../WorkerPool.cpp ../AsciiCase.cpp -o throughput_bench
+ * usage: throughput_bench [database path]
+ */
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <climits>
+#include <cstdlib>
+#include "AhoCorasick.h"
+#include "TokenDictionary.h"
+#include "WeightedScan.h"
+#include "WorkerPool.h"
+#include "BenchUtil.hpp"
+
+#define THROUGHPUT_MSGS 20000
+#define THROUGHPUT_MSG_WORDS 300
+#define THROUGHPUT_PHRASE_PERCENT 2
+#define THROUGHPUT_ROUNDS 3
+#define THROUGHPUT_POINTS_MAX 10
+#define THROUGHPUT_THRESHOLD 50
+#define THROUGHPUT_SCAN_SHARE 100
+
+/**
+ * messages of random filler words, with a bad phrase here and there
+ * @param keys
+ * @return messages
+ */
+std::vector<std::string> benchMessages(const std::vector<std::string>& keys)
+{
+    std::mt19937_64 rng(BENCH_SEED);
+    std::vector<std::string> msgs(THROUGHPUT_MSGS);
+    for (std::string& msg : msgs)
+    {
+        for (int w = 0; w < THROUGHPUT_MSG_WORDS; ++w)
+        {
+            msg += w % 12 == 11 ? ".\n" : " ";
+            if ((int) (rng() % 100) < THROUGHPUT_PHRASE_PERCENT)
+            {
+                msg += keys[rng() % keys.size()];
+                continue;
+            }
+            for (size_t c = 0, len = 2 + rng() % 8; c < len; ++c)
+            {
+                msg += (char) ((c == 0 && rng() % 4 == 0 ? 'A' : 'a') + rng() % 26);
+            }
+        }
+    }
+    return msgs;
+}
+
+/**
+ * scores the first n messages on a pool of threads workers, rounds times, and prints the rates
+ * @tparam MakeScan makes a per worker callable scoring a message against a threshold, given a copy
+ *         of the message it may change
+ * @param name
+ * @param msgs
+ * @param n
+ * @param threads
+ * @param threshold
+ * @param makeScan
+ */
+template<typename MakeScan>
+void measure(const char* name, const std::vector<std::string>& msgs, size_t n, size_t threads, int threshold,
+             MakeScan&& makeScan)
+{
+    WorkerPool pool(threads);
+    std::atomic<long> spam(0);
+    BenchTimer timer;
+    for (int r = 0; r < THROUGHPUT_ROUNDS; ++r)
+    {
+        std::atomic<size_t> next(0);
+        for (size_t w = 0; w < pool.size(); ++w)
+        {
+            pool.submit([&msgs, &next, &spam, &makeScan, n, threshold]
+                        {
+                            auto scan = makeScan();
+                            std::string msg;
+                            long found = 0;
+                            for (size_t i = next++; i < n; i = next++)
+                            {
+                                msg.assign(msgs[i]);
+                                found += scan(msg, threshold);
+                            }
+                            spam += found;
+                        });
+        }
+        if (pool.wait() == EXIT_FAILURE)
+        {
+            std::cerr << "Invalid input\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    double seconds = timer.seconds();
+    benchKeep(spam);
+    double rate = n * THROUGHPUT_ROUNDS / seconds;
+    std::cout << name << " threads " << threads << ": " << rate << " msg/s, " << rate / threads << " msg/s/core, "
+              << 100.0 * spam / (n * THROUGHPUT_ROUNDS) << "% spam\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> keys = benchKeys(argc, argv);
+    std::mt19937_64 rng(BENCH_SEED);
+    std::vector<int> points(keys.size());
+    for (int& p : points)
+    {
+        p = 1 + rng() % THROUGHPUT_POINTS_MAX;
+    }
+    std::vector<std::string> msgs = benchMessages(keys);
+    size_t bytes = 0;
+    for (const std::string& msg : msgs)
+    {
+        bytes += msg.size();
+    }
+
+    AhoCorasick automaton(keys, points);
+    TokenDictionary tokens(keys, points);
+    WeightedScan weighted(keys, points);
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << keys.size() << " phrases, " << msgs.size() << " messages of " << bytes / msgs.size()
+              << " bytes on average, " << cores << " hardware threads\n";
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads < cores; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    counts.push_back(cores);
+    for (size_t threads : counts)
+    {
+        measure("substrings", msgs, msgs.size(), threads, INT_MAX, [&automaton]
+        {
+            return [s = AhoCorasick::Scanner(automaton)](std::string& msg, int threshold) mutable
+            {
+                s.reset();
+                return s.feed(msg.data(), msg.size(), threshold);
+            };
+        });
+        measure("tokens", msgs, msgs.size(), threads, INT_MAX, [&tokens]
+        {
+            return [s = TokenDictionary::Scanner(tokens)](std::string& msg, int threshold) mutable
+            { return s.scan(&msg[0], msg.size(), threshold); };
+        });
+        measure("scan", msgs, msgs.size() / THROUGHPUT_SCAN_SHARE, threads, THROUGHPUT_THRESHOLD, [&weighted]
+        {
+            return [s = WeightedScan::Scanner(weighted)](std::string& msg, int threshold) mutable
+            { return s.scan(&msg[0], msg.size(), threshold); };
+        });
+    }
+    return EXIT_SUCCESS;
+}
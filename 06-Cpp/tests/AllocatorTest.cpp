@@ -0,0 +1,215 @@
+/**
+ * test of HashMap over ArenaAllocator and PoolAllocator, on every layout - inserts, erases, plain
+ * and incremental rehash, copies, moves and swaps must behave as with std::allocator, and the table
+ * storage must come from the arena or pool. arena memory must honor alignments beyond max_align_t,
+ * both from its blocks and for requests big enough to get a block of their own.
+ * run under -fsanitize=address too, pooled blocks are reused across tables.
+ * build: g++ -std=c++17 -O2 -I.. AllocatorTest.cpp -o allocator_test
+ */
+#include <iostream>
+#include <string>
+#include <map>
+#include <random>
+#include <cstdlib>
+#include "HashMap.hpp"
+#include "Allocators.hpp"
+
+#define ALLOC_KEYS 20000
+#define ALLOC_OPS 100000
+#define ALLOC_SMALL_BLOCK 1024
+
+static int failures = 0;
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const std::string& what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ *
+ * @tparam Map
+ * @param map
+ * @param expected
+ * @return if map holds exactly the pairs of expected
+ */
+template<typename Map>
+bool same(const Map& map, const std::map<std::string, int>& expected)
+{
+    if (map.size() != (int) expected.size())
+    {
+        return false;
+    }
+    for (const auto& p : expected)
+    {
+        const int* v = map.get(p.first);
+        if (v == nullptr || *v != p.second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * random inserts, assigns and erases on a map made with alloc, checked against std::map, then
+ * copies, moves and swaps of it
+ * @tparam Layout
+ * @tparam Alloc
+ * @param name
+ * @param alloc
+ * @param step buckets moved per op, 0 for stop-the-world rehash
+ */
+template<typename Layout, typename Alloc>
+void run(const std::string& name, const Alloc& alloc, size_t step)
+{
+    using Map = HashMap<std::string, int, Layout, KeyHash<std::string>, std::equal_to<>, Alloc>;
+    Map map(alloc);
+    map.setIncrementalRehash(step);
+    std::map<std::string, int> expected;
+    std::mt19937 rng(step);
+    for (int i = 0; i < ALLOC_OPS; ++i)
+    {
+        //the key range grows, then shrinks, so the table resizes both ways
+        int range = i < ALLOC_OPS / 2 ? ALLOC_KEYS : ALLOC_KEYS / 20;
+        std::string k = "k" + std::to_string(rng() % range);
+        switch (rng() % 3)
+        {
+            case 0:
+                check(map.erase(k) == (expected.erase(k) == 1), name + " erase");
+                break;
+            case 1:
+                map.insert_or_assign(k, i);
+                expected[k] = i;
+                break;
+            default:
+                check(map.try_emplace(k, i) == expected.emplace(k, i).second, name + " try_emplace");
+        }
+    }
+    //erase what the shrinking range no longer touches, so the map shrinks too
+    for (auto it = expected.begin(); it != expected.end();)
+    {
+        if (std::stoi(it->first.substr(1)) >= ALLOC_KEYS / 20)
+        {
+            check(map.erase(it->first), name + " erase rest");
+            it = expected.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    check(same(map, expected), name + " contents");
+
+    Map copy(map);
+    check(copy == map && same(copy, expected), name + " copy");
+    Map moved(std::move(copy));
+    check(same(moved, expected), name + " move");
+    Map other(alloc);
+    other.insert("other", 1);
+    std::swap(other, moved);
+    check(same(other, expected) && moved.size() == 1 && moved.containsKey("other"), name + " swap");
+    moved = other;
+    check(same(moved, expected), name + " copy assign");
+    other.clear();
+    check(other.empty() && other.get("k1") == nullptr, name + " clear");
+}
+
+/**
+ * runs every layout over an arena and over a pool, stop-the-world and incremental
+ * @tparam Layout
+ * @param name
+ */
+template<typename Layout>
+void runLayout(const std::string& name)
+{
+    using pair = std::pair<std::string, int>;
+    for (size_t step : {0, 4})
+    {
+        std::string tag = name + " step " + std::to_string(step);
+        Arena arena;
+        run<Layout>(tag + " arena", ArenaAllocator<pair>(arena), step);
+        check(arena.bytes() > 0, tag + " arena used");
+        arena.release();
+        check(arena.bytes() == 0, tag + " arena released");
+
+        Pool pool;
+        run<Layout>(tag + " pool", PoolAllocator<pair>(pool), step);
+        check(pool.bytes() > 0, tag + " pool used");
+
+        //the same ops again are served from the blocks the first maps gave back
+        size_t bytes = pool.bytes();
+        run<Layout>(tag + " pool again", PoolAllocator<pair>(pool), step);
+        check(pool.bytes() == bytes, tag + " pool reuse");
+        pool.release();
+    }
+    std::cout << name << " ok\n";
+}
+
+/**
+ * a type aligned past anything operator new gives by default
+ */
+struct alignas(256) Overaligned
+{
+    char bytes[256];
+};
+
+/**
+ * allocates over-aligned objects from an arena with small blocks, after a byte that leaves the
+ * bump pointer unaligned, in sizes that fit a block and sizes that get a block of their own
+ */
+void runOveraligned()
+{
+    Arena arena(ALLOC_SMALL_BLOCK);
+    ArenaAllocator<char> bytes(arena);
+    ArenaAllocator<Overaligned> alloc(arena);
+    bool ok = true;
+    for (size_t n : {1, 2, 1, 3, 8, 1, 40})
+    {
+        bytes.allocate(1);
+        Overaligned* p = alloc.allocate(n);
+        ok = ok && reinterpret_cast<uintptr_t>(p) % alignof(Overaligned) == 0;
+        p[n - 1].bytes[0] = 1;
+    }
+    check(ok, "over-aligned arena allocation");
+
+    //a table of over-aligned pairs
+    using pair = std::pair<int, Overaligned>;
+    HashMap<int, Overaligned, FlatLayout, KeyHash<int>, std::equal_to<>, ArenaAllocator<pair>> map(
+        (ArenaAllocator<pair>(arena)));
+    for (int i = 0; i < ALLOC_KEYS / 20; ++i)
+    {
+        map.insert(i, Overaligned{{(char) i}});
+    }
+    ok = true;
+    for (int i = 0; i < ALLOC_KEYS / 20; ++i)
+    {
+        const Overaligned* v = map.get(i);
+        ok = ok && v != nullptr && reinterpret_cast<uintptr_t>(v) % alignof(Overaligned) == 0;
+        ok = ok && v->bytes[0] == (char) i;
+    }
+    check(ok, "over-aligned values in arena map");
+    std::cout << "over-aligned ok\n";
+}
+
+int main()
+{
+    runLayout<FlatLayout>("flat");
+    runLayout<ChainedLayout>("chained");
+    runLayout<DenseLayout>("dense");
+    runOveraligned();
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/**
+ * stress test of ConcurrentHashMap - many threads insert, erase, assign and look up at once, on
+ * keys of their own and on keys they share, and every value read must be one some thread wrote.
+ * run under -fsanitize=thread to catch races too.
+ * build: g++ -std=c++17 -O2 -pthread -I.. ConcurrentHashMapStress.cpp -o concurrent_stress
+ * usage: concurrent_stress [threads]
+ */
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include "ConcurrentHashMap.hpp"
+
+#define STRESS_THREADS_I 8
+#define STRESS_KEYS 20000
+#define STRESS_SHARED 512
+#define STRESS_OPS 200000
+#define SPREAD_SEGMENTS 16
+#define SPREAD_KEYS 16000
+#define SPREAD_STRIDE (1 << 20)
+
+static std::atomic<int> failures(0);
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const std::string& what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ * std::hash of an int is the int itself, so its high bits are all zero for small keys
+ */
+struct IdentityHash
+{
+    size_t operator()(uint64_t k) const
+    { return k; }
+};
+
+/**
+ * every thread inserts its own keys while looking up the others', then erases half of them, while
+ * all threads also churn a small shared key range whose values always encode their key
+ * @tparam Layout
+ * @param name
+ * @param threads
+ */
+template<typename Layout>
+void stress(const char* name, int threads)
+{
+    ConcurrentHashMap<std::string, long, Layout> map(SPREAD_SEGMENTS);
+    auto own = [](int t, int i)
+    { return "t" + std::to_string(t) + "/" + std::to_string(i); };
+    auto shared = [](int i)
+    { return "s" + std::to_string(i); };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&map, &own, &shared, t, threads]
+                             {
+                                 std::mt19937 rng(t);
+                                 for (int i = 0; i < STRESS_KEYS; ++i)
+                                 {
+                                     check(map.insert(own(t, i), (long) t * STRESS_KEYS + i), "own insert");
+                                     int other = rng() % threads, j = rng() % STRESS_KEYS;
+                                     long v;
+                                     if (map.tryGet(own(other, j), v))
+                                     {
+                                         check(v == (long) other * STRESS_KEYS + j, "own value");
+                                     }
+                                 }
+                                 for (int i = 0; i < STRESS_OPS; ++i)
+                                 {
+                                     int k = rng() % STRESS_SHARED;
+                                     long v;
+                                     switch (rng() % 4)
+                                     {
+                                         case 0:
+                                             map.insert_or_assign(shared(k), (long) k * 1000 + t);
+                                             break;
+                                         case 1:
+                                             map.erase(shared(k));
+                                             break;
+                                         default:
+                                             if (map.tryGet(shared(k), v))
+                                             {
+                                                 check(v / 1000 == k && v % 1000 < threads, "shared value");
+                                             }
+                                     }
+                                 }
+                                 for (int i = 0; i < STRESS_KEYS; i += 2)
+                                 {
+                                     check(map.erase(own(t, i)), "own erase");
+                                 }
+                             });
+    }
+    for (std::thread& w : workers)
+    {
+        w.join();
+    }
+
+    //only odd own keys are left, next to whatever the shared churn left
+    for (int t = 0; t < threads; ++t)
+    {
+        for (int i = 0; i < STRESS_KEYS; ++i)
+        {
+            long v;
+            bool found = map.tryGet(own(t, i), v);
+            check(found == (i % 2 == 1) && (!found || v == (long) t * STRESS_KEYS + i), "final own key");
+        }
+    }
+    int sharedLeft = 0;
+    for (int k = 0; k < STRESS_SHARED; ++k)
+    {
+        sharedLeft += map.containsKey(shared(k));
+    }
+    check(map.size() == threads * STRESS_KEYS / 2 + sharedLeft, "final size");
+    int visited = 0;
+    map.forEach([&visited](const std::pair<std::string, long>&)
+                { ++visited; });
+    check(visited == map.size(), "forEach");
+    std::cout << name << ": " << threads << " threads, " << map.size() << " keys left\n";
+}
+
+/**
+ * keys whose hashes differ only in high bits must still spread over every segment
+ */
+void spread()
+{
+    ConcurrentHashMap<uint64_t, int, FlatLayout, IdentityHash> map(SPREAD_SEGMENTS);
+    for (uint64_t i = 0; i < SPREAD_KEYS; ++i)
+    {
+        map.insert(i * SPREAD_STRIDE, 0);
+    }
+    for (size_t s = 0; s < map.segments(); ++s)
+    {
+        //a fair share is SPREAD_KEYS / SPREAD_SEGMENTS, allow it to be off by half
+        int n = map.segmentSize(s);
+        check(n > SPREAD_KEYS / SPREAD_SEGMENTS / 2 && n < SPREAD_KEYS / SPREAD_SEGMENTS * 3 / 2,
+              "segment " + std::to_string(s) + " holds " + std::to_string(n));
+    }
+    check(map.size() == SPREAD_KEYS && map.containsKey((uint64_t) 5 * SPREAD_STRIDE), "spread lookup");
+    std::cout << "spread: " << SPREAD_KEYS << " keys over " << map.segments() << " segments\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = argc > 1 ? std::atoi(argv[1]) : STRESS_THREADS_I;
+    if (threads <= 0)
+    {
+        std::cerr << "Invalid input\n";
+        return EXIT_FAILURE;
+    }
+    stress<FlatLayout>("flat", threads);
+    stress<ChainedLayout>("chained", threads);
+    stress<DenseLayout>("dense", threads);
+    spread();
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+/**
+ * test of FrameServer - a client which shuts down its side after sending gets every whole request
+ * it sent answered, in order, and then the connection closed; a request cut off by the shutdown is
+ * dropped, and a client which leaves with a request in flight does not hurt the others.
+ * build: g++ -std=c++17 -O2 -pthread -I.. FrameServerTest.cpp ../FrameServer.cpp ../WorkerPool.cpp -o server_test
+ */
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "FrameServer.h"
+
+#define SERVER_WORKERS 2
+#define HANDLER_DELAY_MS 20
+#define CLIENT_TIMEOUT_SECONDS 5
+
+static std::atomic<int> failures(0);
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const char* what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ *
+ * @param body
+ * @return body as a frame
+ */
+std::string frameOf(const std::string& body)
+{
+    std::string frame(FRAME_HEADER, '\0');
+    for (int i = 0; i < FRAME_HEADER; ++i)
+    {
+        frame[i] = (char) (body.size() >> (8 * (FRAME_HEADER - 1 - i)));
+    }
+    return frame + body;
+}
+
+/**
+ * connects a raw socket, which gives up reading after CLIENT_TIMEOUT_SECONDS
+ * @param path
+ * @return socket, -1 on failure
+ */
+int connectTo(const std::string& path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    timeval timeout{CLIENT_TIMEOUT_SECONDS, 0};
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+        connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * sends bytes, then shuts down the sending side and reads everything until the server closes
+ * @param path
+ * @param bytes
+ * @param received all bytes read
+ * @return false if the connection failed, or the server did not close it in time
+ */
+bool sendAndDrain(const std::string& path, const std::string& bytes, std::string& received)
+{
+    int fd = connectTo(path);
+    if (fd < 0 || send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL) != (ssize_t) bytes.size() ||
+        shutdown(fd, SHUT_WR) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    char buf[256];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+    {
+        received.append(buf, n);
+    }
+    close(fd);
+    return n == 0;
+}
+
+int main()
+{
+    std::string path = "/tmp/frame_server_test." + std::to_string(getpid());
+    FrameServer server(path, SERVER_WORKERS); //before any thread, it blocks the signals it watches
+    FrameServer::Handler handler = [](std::string& request)
+    {
+        //slow enough that the shutdown arrives while requests are still in flight
+        std::this_thread::sleep_for(std::chrono::milliseconds(HANDLER_DELAY_MS));
+        return "re:" + request;
+    };
+    std::thread loop([&server, &handler]
+                     { server.run(handler, [] {}); });
+
+    std::string received;
+    check(sendAndDrain(path, frameOf("a") + frameOf("bb") + frameOf("ccc"), received), "half close drained");
+    check(received == frameOf("re:a") + frameOf("re:bb") + frameOf("re:ccc"), "half close replies");
+
+    received.clear();
+    check(sendAndDrain(path, frameOf("whole") + frameOf("cut off").substr(0, FRAME_HEADER + 3), received),
+          "cut off drained");
+    check(received == frameOf("re:whole"), "cut off request dropped");
+
+    received.clear();
+    check(sendAndDrain(path, "", received) && received.empty(), "empty half close");
+
+    //a client gone for good with a request in flight
+    int fd = connectTo(path);
+    std::string frame = frameOf("gone");
+    check(fd >= 0 && send(fd, frame.data(), frame.size(), MSG_NOSIGNAL) == (ssize_t) frame.size(), "gone sent");
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    {
+        FrameClient client(path);
+        std::string reply;
+        check(client.call("x", reply) && reply == "re:x", "plain call");
+        check(client.call("y", reply) && reply == "re:y", "second call");
+    }
+
+    kill(getpid(), SIGTERM);
+    loop.join();
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
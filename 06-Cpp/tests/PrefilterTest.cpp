@@ -0,0 +1,135 @@
+/**
+ * test of the lookup prefilter - a filtered HashMap must answer every find, insert and erase the
+ * same as an unfiltered one through random operations, resizes, rehash(), clear() and
+ * incremental migration, in every layout, and the BloomFilter must never reject an added hash.
+ * build: g++ -std=c++17 -O2 -I.. PrefilterTest.cpp -o prefilter_test
+ */
+#include <iostream>
+#include <string>
+#include <random>
+#include <cstdlib>
+#include "HashMap.hpp"
+
+#define PREFILTER_OPS 200000
+#define PREFILTER_KEYS 5000
+#define PREFILTER_HASHES 100000
+
+static int failures = 0;
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const std::string& what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ * runs the same random operations on a filtered and an unfiltered map, and compares every answer
+ * @tparam Layout
+ * @param name
+ * @param incremental buckets migrated per operation, 0 to resize at once
+ */
+template<typename Layout>
+void checkLayout(const std::string& name, size_t incremental)
+{
+    std::mt19937 rng(PREFILTER_KEYS);
+    HashMap<long, int, Layout> plain, filtered;
+    plain.setIncrementalRehash(incremental);
+    filtered.setIncrementalRehash(incremental);
+    filtered.setPrefilter(true);
+    std::string tag = name + (incremental == 0 ? "" : " incremental");
+
+    for (int i = 0; i < PREFILTER_OPS; ++i)
+    {
+        //a key range a few times the size of the map, so lookups both hit and miss
+        long k = (long) (rng() % PREFILTER_KEYS);
+        unsigned op = rng() % 100;
+        if (op < 40)
+        {
+            const int* a = plain.get(k);
+            const int* b = filtered.get(k);
+            check((a == nullptr) == (b == nullptr) && (a == nullptr || *a == *b), tag + " find " + std::to_string(k));
+        }
+        else if (op < 70)
+        {
+            check(plain.insert_or_assign(k, i) == filtered.insert_or_assign(k, i), tag + " insert");
+        }
+        else if (op < 98)
+        {
+            check(plain.erase(k) == filtered.erase(k), tag + " erase " + std::to_string(k));
+        }
+        else if (op < 99)
+        {
+            size_t buckets = rng() % (2 * PREFILTER_KEYS);
+            plain.rehash(buckets);
+            filtered.rehash(buckets);
+        }
+        else if (rng() % 20 == 0)
+        {
+            plain.clear();
+            filtered.clear();
+        }
+        else
+        {
+            plain.reserve(plain.size() * 2);
+            filtered.reserve(filtered.size() * 2);
+        }
+        check(plain.size() == filtered.size(), tag + " size");
+    }
+
+    //a full sweep at the end, and the filter must survive a copy
+    HashMap<long, int, Layout> copy(filtered);
+    check(copy.hasPrefilter(), tag + " copy keeps prefilter");
+    for (long k = 0; k < PREFILTER_KEYS * 2; ++k)
+    {
+        check(plain.containsKey(k) == filtered.containsKey(k) && plain.containsKey(k) == copy.containsKey(k),
+              tag + " sweep " + std::to_string(k));
+    }
+    check(plain == filtered && filtered == copy, tag + " equal");
+}
+
+int main()
+{
+    checkLayout<FlatLayout>("flat", 0);
+    checkLayout<FlatLayout>("flat", 4);
+    checkLayout<ChainedLayout>("chained", 0);
+    checkLayout<ChainedLayout>("chained", 4);
+    checkLayout<DenseLayout>("dense", 0);
+    checkLayout<DenseLayout>("dense", 4);
+
+    //no false negatives, and false positives near the 1% of 10 bits per key
+    std::mt19937_64 rng(PREFILTER_HASHES);
+    BloomFilter filter(PREFILTER_HASHES);
+    std::vector<uint64_t> hashes(PREFILTER_HASHES);
+    for (uint64_t& h : hashes)
+    {
+        h = rng();
+        filter.add(h);
+    }
+    bool all = true;
+    for (uint64_t h : hashes)
+    {
+        all = all && filter.mayContain(h);
+    }
+    check(all, "bloom filter rejects an added hash");
+    size_t positives = 0;
+    for (int i = 0; i < PREFILTER_HASHES; ++i)
+    {
+        positives += filter.mayContain(rng());
+    }
+    check(positives < PREFILTER_HASHES / 25, "bloom filter false positive rate " + std::to_string(positives));
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/**
+ * test of SnapshotMap - readers look up while a writer publishes version after version, and every
+ * lookup must agree with the version it reports. snapshot v holds keys 1..v, with value = key.
+ * it runs once more with the prefilter on - snapshots are copies that keep it, and readers must
+ * still only read, with no shared counter between them. run under -fsanitize=thread to catch
+ * races, and under -fsanitize=address for reclamation.
+ * build: g++ -std=c++17 -O2 -pthread -I.. SnapshotMapTest.cpp -o snapshot_test
+ */
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include "SnapshotMap.hpp"
+#include "ConcurrentHashMap.hpp" //both define their cache line alignment through CacheLine.hpp
+
+#define SNAPSHOT_READERS 4
+#define SNAPSHOT_VERSIONS 2000
+
+static std::atomic<int> failures(0);
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const char* what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ *
+ * @param i
+ * @return key i
+ */
+std::string key(uint64_t i)
+{ return "k" + std::to_string(i); }
+
+/**
+ * publishes versions 2..SNAPSHOT_VERSIONS while readers look up
+ * @param prefilter if the first snapshot, and so every later one, has a prefilter
+ */
+void checkSnapshots(bool prefilter)
+{
+    HashMap<std::string, uint64_t> first;
+    first.insert(key(1), 1);
+    first.setPrefilter(prefilter);
+    SnapshotMap<std::string, uint64_t> map(first);
+    check(map.version() == 1, "first version");
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < SNAPSHOT_READERS; ++r)
+    {
+        readers.emplace_back([&map, &done, r, prefilter]
+                             {
+                                 auto reader = map.reader();
+                                 std::mt19937_64 rng(r);
+                                 uint64_t last = 0;
+                                 while (!done)
+                                 {
+                                     uint64_t k = 1 + rng() % SNAPSHOT_VERSIONS, v = 0, version = 0;
+                                     bool found = reader.tryGet(key(k), v, version);
+                                     check(found == (k <= version), "found matches version");
+                                     check(!found || v == k, "value");
+                                     check(version >= last, "versions never go back");
+                                     last = version;
+
+                                     //a whole snapshot is consistent too
+                                     reader.read([prefilter](const SnapshotMap<std::string, uint64_t>::snapshot& s)
+                                                 {
+                                                     check((uint64_t) s.map.size() == s.version, "size");
+                                                     check(s.map.containsKey(key(s.version)), "newest key");
+                                                     check(!s.map.containsKey(key(s.version + 1)), "next key");
+                                                     check(s.map.hasPrefilter() == prefilter, "prefilter kept");
+                                                 });
+                                 }
+                             });
+    }
+
+    for (uint64_t v = 2; v <= SNAPSHOT_VERSIONS; ++v)
+    {
+        uint64_t published = map.update([v](HashMap<std::string, uint64_t>& next)
+                                        { next.insert(key(v), v); });
+        check(published == v, "published version");
+    }
+    done = true;
+    for (std::thread& r : readers)
+    {
+        r.join();
+    }
+
+    //the last snapshot equals a map built directly, and a fresh reader sees it
+    HashMap<std::string, uint64_t> expected;
+    for (uint64_t v = 1; v <= SNAPSHOT_VERSIONS; ++v)
+    {
+        expected.insert(key(v), v);
+    }
+    auto reader = map.reader();
+    check(reader.read([&expected](const SnapshotMap<std::string, uint64_t>::snapshot& s)
+                      { return s.map == expected; }), "last snapshot");
+    uint64_t value = 0;
+    check(!reader.tryGet(key(SNAPSHOT_VERSIONS + 1), value) && reader.tryGet(key(7), value) && value == 7,
+          "plain tryGet");
+    map.reclaim();
+}
+
+int main()
+{
+    checkSnapshots(false);
+    checkSnapshots(true);
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
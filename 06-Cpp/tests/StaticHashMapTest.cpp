@@ -0,0 +1,135 @@
+/**
+ * test of StaticHashMap - every key built in must be found with the value of its last duplicate,
+ * by std::string, std::string_view and const char*, keys never built in must be missed, and maps
+ * of every small size must build. run under -fsanitize=address too.
+ * build: g++ -std=c++17 -O2 -I.. StaticHashMapTest.cpp -o static_map_test
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <map>
+#include <random>
+#include <cstdlib>
+#include "StaticHashMap.hpp"
+
+#define STATIC_KEYS 100000
+#define STATIC_SMALL 40
+
+static int failures = 0;
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const std::string& what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+/**
+ * builds a map of n random words with some duplicates, and checks it against std::map
+ * @param n
+ */
+void checkStrings(size_t n)
+{
+    std::mt19937 rng((unsigned) n);
+    std::vector<std::string> keys;
+    std::vector<int> values;
+    std::map<std::string, int> expected;
+    for (size_t i = 0; i < n; ++i)
+    {
+        //about one key in ten repeats an earlier one, the later value wins
+        std::string k = (i > 0 && rng() % 10 == 0) ? keys[rng() % i] : "w" + std::to_string(rng());
+        keys.push_back(k);
+        values.push_back((int) i);
+        expected[k] = (int) i;
+    }
+    StaticHashMap<std::string, int> map(keys, values);
+    std::string tag = std::to_string(n) + " keys";
+    check(map.size() == (int) expected.size() && map.empty() == expected.empty(), tag + " size");
+
+    for (const auto& p : expected)
+    {
+        const int* v = map.get(std::string_view(p.first));
+        check(v != nullptr && *v == p.second, tag + " get");
+        check(map.containsKey(p.first) && map.containsKey(p.first.c_str()), tag + " containsKey");
+        check(map.at(p.first) == p.second, tag + " at");
+        check(map.get(p.first + "#") == nullptr && !map.containsKey(std::string_view(p.first).substr(1)),
+              tag + " miss");
+    }
+
+    size_t visited = 0;
+    map.forEach([&expected, &visited, &tag](const std::string& k, int v)
+                {
+                    auto it = expected.find(k);
+                    check(it != expected.end() && it->second == v, tag + " forEach");
+                    ++visited;
+                });
+    check(visited == expected.size(), tag + " forEach count");
+
+    //the map reports what it throws on cerr
+    bool threw = false;
+    std::cerr.setstate(std::ios::failbit);
+    try
+    {
+        map.at("not a key");
+    }
+    catch (std::out_of_range& e)
+    {
+        threw = true;
+    }
+    std::cerr.clear();
+    check(threw, tag + " at miss");
+}
+
+int main()
+{
+    for (size_t n = 0; n <= STATIC_SMALL; ++n)
+    {
+        checkStrings(n);
+    }
+    checkStrings(STATIC_KEYS);
+
+    //integral keys go through the mixing KeyHash
+    std::vector<long> ints;
+    std::vector<int> values;
+    for (long i = 0; i < STATIC_KEYS; ++i)
+    {
+        ints.push_back(i * 3);
+        values.push_back((int) i);
+    }
+    StaticHashMap<long, int> intMap(ints, values);
+    bool ok = intMap.size() == STATIC_KEYS;
+    for (long i = 0; i < STATIC_KEYS * 3; ++i)
+    {
+        const int* v = intMap.get(i);
+        ok = ok && (i % 3 == 0 ? v != nullptr && *v == i / 3 : v == nullptr);
+    }
+    check(ok, "int keys");
+    check(intMap.bitsPerKey() > 3 && intMap.bitsPerKey() < 3.5, "bits per key");
+
+    bool threw = false;
+    std::cerr.setstate(std::ios::failbit);
+    try
+    {
+        StaticHashMap<long, int> bad(ints, std::vector<int>(1));
+    }
+    catch (std::invalid_argument& e)
+    {
+        threw = true;
+    }
+    std::cerr.clear();
+    check(threw, "sizes differ");
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
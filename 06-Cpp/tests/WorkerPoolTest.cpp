@@ -0,0 +1,71 @@
+/**
+ * test of WorkerPool - tasks that throw must not take the process down, the tasks around them
+ * still run, and wait() reports the failure once.
+ * build: g++ -std=c++17 -O2 -pthread -I.. WorkerPoolTest.cpp ../WorkerPool.cpp -o pool_test
+ */
+#include <iostream>
+#include <atomic>
+#include <stdexcept>
+#include <cstdlib>
+#include "WorkerPool.h"
+
+#define POOL_THREADS 4
+#define POOL_TASKS 1000
+#define POOL_THROW_EVERY 7
+
+static std::atomic<int> failures(0);
+
+/**
+ * counts a failure and reports it
+ * @param ok
+ * @param what
+ */
+void check(bool ok, const char* what)
+{
+    if (!ok && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+    }
+}
+
+int main()
+{
+    WorkerPool pool(POOL_THREADS);
+    std::atomic<int> ran(0);
+    for (int i = 0; i < POOL_TASKS; ++i)
+    {
+        pool.submit([&ran, i]
+                    {
+                        if (i % POOL_THROW_EVERY == 0)
+                        {
+                            throw std::runtime_error("task failed");
+                        }
+                        ++ran;
+                    });
+    }
+    check(pool.wait() == EXIT_FAILURE, "failure reported");
+    check(ran == POOL_TASKS - (POOL_TASKS + POOL_THROW_EVERY - 1) / POOL_THROW_EVERY, "other tasks ran");
+
+    //reported once, and the workers are all still there
+    check(pool.wait() == EXIT_SUCCESS, "failure cleared");
+    for (int i = 0; i < POOL_TASKS; ++i)
+    {
+        pool.submit([&ran]
+                    { ++ran; });
+    }
+    check(pool.wait() == EXIT_SUCCESS, "clean run");
+    check(ran == 2 * POOL_TASKS - (POOL_TASKS + POOL_THROW_EVERY - 1) / POOL_THROW_EVERY, "pool still works");
+
+    //a task that throws something else is caught too
+    pool.submit([]
+                { throw 1; });
+    check(pool.wait() == EXIT_FAILURE, "non std exception");
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}